@@ -0,0 +1,66 @@
+#include "../std_lib_facilities.h"
+#include <chrono>
+#undef vector
+
+// the time f() takes, with the value it returns
+template<class F>
+void time_it(const string& name, F f)
+{
+	auto t1 = chrono::steady_clock::now();
+	auto r = f();
+	auto t2 = chrono::steady_clock::now();
+	cout << name << chrono::duration<double>(t2-t1).count() << " s, " << r << '\n';
+}
+
+// a loop of operator[], as course code writes it
+template<class V>
+long sum_indexed(const V& v)
+{
+	long s = 0;
+	for (unsigned int i = 0; i<v.size(); ++i)
+		s += v[i];
+	return s;
+}
+
+template<class V>
+long sum_iterated(const V& v)
+{
+	long s = 0;
+	for (auto p = v.begin(); p!=v.end(); ++p)
+		s += *p;
+	return s;
+}
+
+// usage: vector_bench [n]
+// sums n ints (default 100'000'000) with Vector and std::vector, 10 times;
+// build it as vector_bench (release) and as vector_bench_debug to compare
+int main(int argc, char* argv[])
+try {
+	const size_t n = argc>1 ? atol(argv[1]) : 100'000'000;
+	const int rounds = 10;
+	cout << "PPP_RANGE_CHECK " << PPP_RANGE_CHECK << ", " << n << " ints\n";
+
+	std::vector<int> sv(n);
+	Vector<int> v(n);
+	for (size_t i = 0; i<n; ++i)
+		sv[i] = v[i] = i%100;
+
+	time_it("std::vector, operator[]: ", [&]{ long s = 0; for (int r = 0; r<rounds; ++r) s += sum_indexed(sv); return s; });
+	time_it("Vector, operator[]:      ", [&]{ long s = 0; for (int r = 0; r<rounds; ++r) s += sum_indexed(v); return s; });
+	time_it("std::vector, iterators:  ", [&]{ long s = 0; for (int r = 0; r<rounds; ++r) s += sum_iterated(sv); return s; });
+	time_it("Vector, iterators:       ", [&]{ long s = 0; for (int r = 0; r<rounds; ++r) s += sum_iterated(v); return s; });
+
+#if PPP_RANGE_CHECK
+	// what release builds leave undefined
+	try {
+		v[n];
+	}
+	catch (Range_error& e) {
+		cout << "v[n]: " << e.what() << '\n';
+	}
+#endif
+}
+catch (exception& e) {
+	cerr << e.what() << '\n';
+	return 1;
+}
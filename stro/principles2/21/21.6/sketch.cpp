@@ -0,0 +1,162 @@
+#include "sketch.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+namespace my {
+namespace Words {
+
+namespace {
+
+// a second, independent hash for double hashing the rows
+std::size_t mix(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+constexpr std::size_t sketch_depth = 4;     // delta = e^-4, about 2%
+constexpr std::size_t min_width = 64;
+
+} // namespace
+
+Count_min::Count_min(std::size_t width, std::size_t depth)
+    : w{width}
+    , d{depth}
+    , cells(width * depth)
+{
+    if(w == 0 || (w & (w - 1)) != 0 || d == 0)
+        throw std::invalid_argument{"Count_min: width must be a power of 2"};
+}
+
+std::uint64_t Count_min::add(std::size_t h)
+{
+    const std::uint64_t m = estimate(h) + 1;
+    const std::size_t h2 = mix(h) | 1;
+    for(std::size_t i = 0; i < d; ++i) {
+        std::uint64_t& c = cells[i * w + ((h + i * h2) & (w - 1))];
+        if(c < m) c = m;
+    }
+    ++n;
+    return m;
+}
+
+std::uint64_t Count_min::estimate(std::size_t h) const
+{
+    const std::size_t h2 = mix(h) | 1;
+    std::uint64_t m = UINT64_MAX;
+    for(std::size_t i = 0; i < d; ++i)
+        m = std::min(m, cells[i * w + ((h + i * h2) & (w - 1))]);
+    return m;
+}
+
+double Count_min::epsilon() const { return std::exp(1.0) / w; }
+double Count_min::delta() const { return std::exp(-double(d)); }
+
+std::size_t Top_k::summary_bytes(std::size_t k)
+{
+    // heap entry and word, plus a hash node and a bucket for the index
+    return k * (sizeof(Entry) + sizeof(std::string) + 4 * sizeof(void*)
+                + sizeof(std::string_view) + sizeof(std::size_t));
+}
+
+static std::size_t sketch_width(std::size_t k, std::size_t budget)
+{
+    const std::size_t s = Top_k::summary_bytes(k);
+    std::size_t w = min_width;
+    if(budget < s || (budget - s) / (sketch_depth * sizeof(std::uint64_t)) < w)
+        throw std::invalid_argument{"memory budget too small for top " + std::to_string(k)};
+    while(w * 2 * sketch_depth * sizeof(std::uint64_t) <= budget - s) w *= 2;
+    return w;
+}
+
+Top_k::Top_k(std::size_t kk, std::size_t memory_budget)
+    : k{kk}
+    , cms{sketch_width(kk, memory_budget), sketch_depth}
+{
+    if(k == 0) throw std::invalid_argument{"Top_k: k must be positive"};
+    words.reserve(k);
+    heap.reserve(k);
+    pos.reserve(k);
+}
+
+void Top_k::place(std::size_t i, Entry e)
+{
+    pos[e.word] = i;
+    heap[i] = e;
+}
+
+void Top_k::sift_down(std::size_t i)
+{
+    Entry e = heap[i];
+    for(;;) {
+        std::size_t c = 2 * i + 1;
+        if(c >= heap.size()) break;
+        if(c + 1 < heap.size() && heap[c + 1].count < heap[c].count) ++c;
+        if(e.count <= heap[c].count) break;
+        place(i, heap[c]);
+        i = c;
+    }
+    place(i, e);
+}
+
+void Top_k::add(std::string_view w)
+{
+    const std::size_t h = std::hash<std::string_view>{}(w);
+    const std::uint64_t est = cms.add(h);
+
+    if(auto p = pos.find(w); p != pos.end()) {
+        ++heap[p->second].count;
+        sift_down(p->second);
+        return;
+    }
+
+    if(heap.size() < k) {
+        // every word so far is monitored, so this one is new: count 1 is the minimum
+        words.emplace_back(w);
+        const Entry e {words.back(), 1, 0, words.size() - 1};
+        heap.push_back(e);
+        std::size_t i = heap.size() - 1;
+        while(i > 0) {
+            std::size_t parent = (i - 1) / 2;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, e);
+        return;
+    }
+
+    // w has occurred at most est times; if that cannot beat the minimum,
+    // the minimum still bounds every unmonitored word
+    const Entry& least = heap[0];
+    if(est <= least.count) return;
+
+    // w takes over the least one's place and its copy of a word
+    const Entry old = least;
+    pos.erase(old.word);
+    words[old.slot] = w;
+    place(0, Entry{words[old.slot], old.count + 1, old.count, old.slot});
+    sift_down(0);
+}
+
+std::vector<Word_estimate> Top_k::top() const
+{
+    std::vector<Word_estimate> v;
+    v.reserve(heap.size());
+    for(const auto& e : heap) {
+        const std::uint64_t est = cms.estimate(std::hash<std::string_view>{}(e.word));
+        v.push_back(Word_estimate{e.word, e.count - e.error, std::min(e.count, est)});
+    }
+    std::sort(v.begin(), v.end(),
+        [](const Word_estimate& a, const Word_estimate& b){
+            return a.upper != b.upper ? a.upper > b.upper : a.word < b.word;
+        }
+    );
+    return v;
+}
+
+} // namespace Words
+} // namespace my
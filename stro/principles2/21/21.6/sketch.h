@@ -0,0 +1,91 @@
+#ifndef MY_WORDS_SKETCH_H
+#define MY_WORDS_SKETCH_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace my {
+namespace Words {
+
+/**
+ * Count-min sketch: depth rows of width counters.
+ * estimate(w) never undercounts, and overcounts by at most
+ * epsilon()*total() with probability 1-delta().
+ * Updates are conservative: only the counters at the minimum grow.
+ */
+class Count_min {
+    std::size_t w;      // a power of 2
+    std::size_t d;
+    std::vector<std::uint64_t> cells;
+    std::uint64_t n = 0;
+public:
+    Count_min(std::size_t width, std::size_t depth);
+
+    // h is std::hash<string_view>{}(word); returns the new estimate
+    std::uint64_t add(std::size_t h);
+    std::uint64_t estimate(std::size_t h) const;
+
+    std::size_t width() const { return w; }
+    std::size_t depth() const { return d; }
+    std::uint64_t total() const { return n; }
+    double epsilon() const;
+    double delta() const;
+    std::size_t bytes() const { return cells.size() * sizeof(std::uint64_t); }
+};
+
+/**
+ * A word and the bounds on its true count: lower <= true <= upper.
+ */
+struct Word_estimate {
+    std::string_view word;
+    std::uint64_t lower;
+    std::uint64_t upper;
+};
+
+/**
+ * Space-saving summary of the k most frequent words in bounded memory.
+ * A count-min sketch filters the stream: an unmonitored word replaces
+ * the least frequent monitored one only if the sketch says it could
+ * have overtaken it, which keeps the space-saving guarantee while
+ * sparing the heap the churn of rare words.
+ * The monitored words are copied, so the text need not outlive add():
+ * it can be read a block at a time, as from a pipe.
+ */
+class Top_k {
+    struct Entry {
+        std::string_view word;  // into words[slot]
+        std::uint64_t count;    // upper bound
+        std::uint64_t error;    // count-error is a lower bound
+        std::size_t slot;
+    };
+
+    std::size_t k;
+    Count_min cms;
+    std::vector<std::string> words;     // k at most, never reallocated
+    std::vector<Entry> heap;    // min-heap on count
+    std::unordered_map<std::string_view, std::size_t> pos;     // word -> heap index
+
+    void place(std::size_t i, Entry e);
+    void sift_down(std::size_t i);
+public:
+    // memory_budget covers the sketch and the summary together
+    Top_k(std::size_t k, std::size_t memory_budget);
+
+    void add(std::string_view w);
+
+    // at most k words, most frequent first
+    std::vector<Word_estimate> top() const;
+    const Count_min& sketch() const { return cms; }
+
+    // what a summary of k words costs, sketch aside and words longer
+    // than std::string holds in place aside
+    static std::size_t summary_bytes(std::size_t k);
+};
+
+} // namespace Words
+} // namespace my
+
+#endif
@@ -0,0 +1,70 @@
+#include "../../tokenizer.h"
+#include "../../mapped_file.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cassert>
+#include <cstdlib>
+
+// word count and total length, so nothing is optimized away
+struct Tally {
+    std::size_t words = 0;
+    std::size_t chars = 0;
+    bool operator==(const Tally& t) const { return words == t.words && chars == t.chars; }
+};
+
+template<typename F>
+Tally time_it(const char* name, std::size_t bytes, F f)
+{
+    using namespace std::chrono;
+    auto t1 = steady_clock::now();
+    Tally t = f();
+    auto t2 = steady_clock::now();
+    double s = duration<double>(t2 - t1).count();
+    std::cout << name << t.words << " words, "
+        << s << " s, " << bytes / s / (1 << 20) << " MB/s\n";
+    return t;
+}
+
+// usage: tokenizer_bench [megabytes]
+// tokenizes feeds.txt repeated to the given size (default 1024)
+int main(int argc, char* argv[])
+{
+    std::size_t mb = argc > 1 ? std::atoi(argv[1]) : 1024;
+    my::Mapped_file feeds {"feeds.txt"};
+    std::string text;
+    text.reserve(mb << 20);
+    while(text.size() + feeds.size() + 1 <= mb << 20) {
+        text.append(feeds.view());
+        text += '\n';
+    }
+    std::cout << "feeds.txt x" << text.size() / (feeds.size() + 1)
+        << " = " << (text.size() >> 20) << " MB\n";
+
+    // the machinery of std::cin >> s, on a stream that never touches disk
+    Tally a = time_it("istream >> string: ", text.size(), [&]{
+        Tally t;
+        std::istringstream is {text};
+        for(std::string s; is >> s; ) {
+            ++t.words;
+            t.chars += s.size();
+        }
+        return t;
+    });
+
+    auto tokenize = [&](my::Space_mask f) {
+        Tally t;
+        my::Tokenizer tk {text, f};
+        for(std::string_view w; tk.next(w); ) {
+            ++t.words;
+            t.chars += w.size();
+        }
+        return t;
+    };
+    Tally b = time_it("Tokenizer, scalar:  ", text.size(), [&]{ return tokenize(my::space_mask_scalar); });
+    Tally c = time_it("Tokenizer, best:    ", text.size(), [&]{ return tokenize(my::best_space_mask()); });
+
+    assert(a == b);
+    assert(a == c);
+}
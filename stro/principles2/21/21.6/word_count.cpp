@@ -0,0 +1,163 @@
+#include "word_count.h"
+#include "../../tokenizer.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+namespace my {
+namespace Words {
+
+namespace {
+
+std::size_t round_up_pow2(std::size_t n)
+{
+    std::size_t c = 16;
+    while(c < n) c *= 2;
+    return c;
+}
+
+// below this a thread costs more than it saves
+constexpr std::size_t min_chunk = 1 << 20;
+
+} // namespace
+
+Word_table::Word_table(std::size_t capacity)
+    : slots(round_up_pow2(capacity))
+{}
+
+void Word_table::grow()
+{
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    const std::size_t mask = slots.size() - 1;
+    for(const auto& s : old) {
+        if(s.count == 0) continue;
+        std::size_t i = s.hash & mask;
+        while(slots[i].count != 0) i = (i + 1) & mask;
+        slots[i] = s;
+    }
+}
+
+void Word_table::add(std::string_view w, std::uint64_t n)
+{
+    const std::size_t h = std::hash<std::string_view>{}(w);
+    const std::size_t mask = slots.size() - 1;
+    for(std::size_t i = h & mask; ; i = (i + 1) & mask) {
+        Slot& s = slots[i];
+        if(s.count == 0) {
+            s = Slot{w, h, n};
+            if(++used * 2 > slots.size()) grow();
+            return;
+        }
+        if(s.hash == h && s.word == w) {
+            s.count += n;
+            return;
+        }
+    }
+}
+
+void Word_table::merge(const Word_table& t)
+{
+    for(const auto& s : t.slots)
+        if(s.count != 0) add(s.word, s.count);
+}
+
+std::vector<Word_freq> Word_table::sorted() const
+{
+    std::vector<Word_freq> v;
+    v.reserve(used);
+    for(const auto& s : slots)
+        if(s.count != 0) v.emplace_back(s.word, s.count);
+    std::sort(v.begin(), v.end(),
+        [](const Word_freq& a, const Word_freq& b){ return a.first < b.first; }
+    );
+    return v;
+}
+
+std::vector<std::string_view> split_chunks(std::string_view text, unsigned n)
+{
+    std::vector<std::string_view> chunks;
+    if(n == 0) n = 1;
+    std::size_t first = 0;
+    for(unsigned i = 1; i < n; ++i) {
+        std::size_t p = std::max(first, text.size() / n * i);
+        while(p < text.size() && !is_space(text[p])) ++p;
+        if(p == text.size()) break;
+        chunks.push_back(text.substr(first, p - first));
+        first = p;
+    }
+    chunks.push_back(text.substr(first));
+    return chunks;
+}
+
+Word_table count_words(std::string_view text, unsigned nthreads)
+{
+    if(nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+    nthreads = std::max<std::size_t>(1, std::min<std::size_t>(nthreads, text.size() / min_chunk));
+
+    auto chunks = split_chunks(text, nthreads);
+    std::vector<Word_table> tables(chunks.size());
+    auto count_chunk = [&](std::size_t i) {
+        for_each_word(chunks[i], [&](std::string_view w){ tables[i].add(w); });
+    };
+
+    std::vector<std::thread> threads;
+    for(std::size_t i = 1; i < chunks.size(); ++i)
+        threads.emplace_back(count_chunk, i);
+    count_chunk(0);
+    for(auto& t : threads) t.join();
+
+    auto largest = std::max_element(tables.begin(), tables.end(),
+        [](const Word_table& a, const Word_table& b){ return a.size() < b.size(); }
+    );
+    Word_table result = std::move(*largest);
+    for(auto p = tables.begin(); p != tables.end(); ++p)
+        if(p != largest) result.merge(*p);
+    return result;
+}
+
+void read_words(int fd, const std::function<void(std::string_view)>& f)
+{
+    std::vector<char> buf(1 << 20);
+    std::size_t kept = 0;       // the start of a word cut by the last read
+    for(;;) {
+        if(kept == buf.size()) buf.resize(buf.size() * 2);
+        ssize_t n = ::read(fd, buf.data() + kept, buf.size() - kept);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            throw std::runtime_error{std::string{"read: "} + std::strerror(errno)};
+        }
+        std::string_view text {buf.data(), kept + n};
+        if(n == 0) {
+            for_each_word(text, f);
+            break;
+        }
+        std::size_t end = text.size();
+        while(end != 0 && !is_space(text[end - 1])) --end;
+        for_each_word(text.substr(0, end), f);
+        kept = text.size() - end;
+        std::memmove(buf.data(), buf.data() + end, kept);
+    }
+}
+
+Word_table count_words(int fd, Interner& words)
+{
+    std::vector<std::uint64_t> counts;      // by word id
+    read_words(fd, [&](std::string_view w) {
+        Interner::Id id = words.intern(w);
+        if(id == counts.size()) counts.push_back(0);
+        ++counts[id];
+    });
+
+    Word_table t {counts.size() * 2};
+    for(Interner::Id id = 0; id < counts.size(); ++id)
+        t.add(words.view(id), counts[id]);
+    return t;
+}
+
+} // namespace Words
+} // namespace my
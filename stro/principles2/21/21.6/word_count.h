@@ -0,0 +1,72 @@
+#ifndef MY_WORDS_WORD_COUNT_H
+#define MY_WORDS_WORD_COUNT_H
+
+#include "../../interner.h"
+#include <functional>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace my {
+namespace Words {
+
+typedef std::pair<std::string_view, std::uint64_t> Word_freq;
+
+/**
+ * Open-addressing (linear probing) hash table from word to count.
+ * Keys are string_views into the counted text, so the text must
+ * outlive the table; no word is ever copied.
+ */
+class Word_table {
+    struct Slot {
+        std::string_view word;
+        std::size_t hash = 0;
+        std::uint64_t count = 0;    // 0 marks an empty slot
+    };
+
+    std::vector<Slot> slots;
+    std::size_t used = 0;
+
+    void grow();
+public:
+    explicit Word_table(std::size_t capacity = 1024);
+
+    void add(std::string_view w, std::uint64_t n = 1);
+    void merge(const Word_table&);
+    std::size_t size() const { return used; }
+
+    // the (word, count) pairs in the order of std::map<string,int>
+    std::vector<Word_freq> sorted() const;
+};
+
+/**
+ * Splits text into at most n chunks of about equal size.
+ * Every boundary falls on whitespace, so no word straddles two chunks.
+ */
+std::vector<std::string_view> split_chunks(std::string_view text, unsigned n);
+
+/**
+ * Counts the words of text on nthreads threads (0 means one per core):
+ * one Word_table per chunk, merged at the end.
+ */
+Word_table count_words(std::string_view text, unsigned nthreads = 0);
+
+/**
+ * f(word) for each word read from fd, e.g. a pipe, a block at a time.
+ * Each word is valid only during its call; memory is one block and
+ * the longest word.
+ */
+void read_words(int fd, const std::function<void(std::string_view)>& f);
+
+/**
+ * Counts the words read from fd, e.g. a pipe, a block at a time.
+ * Only the vocabulary is kept, interned in words, so input of any size
+ * fits in memory; the table's keys live as long as words does.
+ */
+Word_table count_words(int fd, Interner& words);
+
+} // namespace Words
+} // namespace my
+
+#endif
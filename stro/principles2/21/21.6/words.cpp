@@ -1,15 +1,120 @@
+#include "word_count.h"
+#include "sketch.h"
+#include "../../tokenizer.h"
+#include "../../mapped_file.h"
 #include <iostream>
-#include <map>
+#include <string>
+#include <stdexcept>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <limits>
+#include <optional>
 
-int main()
+// s as a number of digits, with no sign or space before it and nothing
+// after it but a suffix strtoull stops at; throws bad if it overflows
+template<typename E>
+std::size_t to_number(const std::string& s, char*& end, const E& bad)
 {
-    std::map<std::string, int> words;
+    if(s.empty() || !std::isdigit(static_cast<unsigned char>(s[0]))) throw bad();
+    errno = 0;
+    const unsigned long long n = std::strtoull(s.c_str(), &end, 10);
+    if(errno == ERANGE || n > std::numeric_limits<std::size_t>::max()) throw bad();
+    return n;
+}
 
-    for(std::string s; std::cin >> s;)
-        ++words[s];
+// "64M" -> 64<<20; K, M and G suffixes are accepted
+std::size_t to_bytes(const std::string& s)
+{
+    const auto bad = [&]{ return std::invalid_argument{"bad memory budget [" + s + "]"}; };
+    char* end;
+    const std::size_t n = to_number(s, end, bad);
+    int shift = 0;
+    switch(*end) {
+    case 'G': case 'g': shift = 30; ++end; break;
+    case 'M': case 'm': shift = 20; ++end; break;
+    case 'K': case 'k': shift = 10; ++end; break;
+    }
+    if(*end != '\0' || n > std::numeric_limits<std::size_t>::max() >> shift) throw bad();
+    return n << shift;
+}
+
+// "10" -> 10; anything but a positive number is an error
+std::size_t to_count(const std::string& s)
+{
+    const auto bad = [&]{
+        return std::invalid_argument{"bad K [" + s + "]: usage: words -k K [-m budget] [file]"};
+    };
+    char* end;
+    const std::size_t n = to_number(s, end, bad);
+    if(*end != '\0' || n == 0) throw bad();
+    return n;
+}
+
+// usage: words [-j threads] [file]
+//        words -k K [-m budget] [file]
+// reads stdin when no file is given.
+// The first form counts every word exactly; the second reports
+// the K most frequent words, within bounds, in budget bytes.
+int main(int argc, char* argv[])
+try
+{
+    unsigned nthreads = 0;
+    std::size_t k = 0;
+    std::size_t budget = 64 << 20;
+    std::string path;
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(arg == "-j" && i+1 < argc)
+            nthreads = std::atoi(argv[++i]);
+        else if(arg == "-k" && i+1 < argc)
+            k = to_count(argv[++i]);
+        else if(arg == "-m" && i+1 < argc)
+            budget = to_bytes(argv[++i]);
+        else
+            path = arg;
+    }
+
+    // a pipe is read a block at a time, keeping only the vocabulary, or
+    // only the monitored words, not the whole input
+    const bool stream = path.empty() && !my::Mapped_file::can_map(0);
+
+    if(k == 0 && stream) {
+        my::Interner vocabulary;
+        auto words = my::Words::count_words(0, vocabulary);
+        for(const auto& p : words.sorted())
+            std::cout << p.first << " : " << p.second << '\n';
+        return 0;
+    }
+
+    std::optional<my::Mapped_file> in;
+    if(!stream) in.emplace(path.empty() ? my::Mapped_file{0} : my::Mapped_file{path});
+
+    if(k == 0) {
+        auto words = my::Words::count_words(in->view(), nthreads);
+        for(const auto& p : words.sorted())
+            std::cout << p.first << " : " << p.second << '\n';
+        return 0;
+    }
+
+    my::Words::Top_k top {k, budget};
+    if(stream)
+        my::Words::read_words(0, [&](std::string_view w){ top.add(w); });
+    else
+        my::for_each_word(in->view(), [&](std::string_view w){ top.add(w); });
 
-    for(const auto& p : words)
-        std::cout << p.first << " : " << p.second << std::endl;
+    const auto& cms = top.sketch();
+    std::cerr << "count-min " << cms.width() << 'x' << cms.depth()
+        << " (" << cms.bytes() << " bytes): over by at most "
+        << static_cast<std::uint64_t>(cms.epsilon() * cms.total())
+        << " of " << cms.total() << " words with probability "
+        << 1 - cms.delta() << std::endl;
+    for(const auto& e : top.top())
+        std::cout << e.word << " : " << e.upper << " [" << e.lower << ',' << e.upper << "]\n";
 
     return 0;
-}
\ No newline at end of file
+}
+catch(std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+}
@@ -1,93 +1,107 @@
+#include "item_table.h"
 #include <iostream>
-#include <fstream>
+#include <filesystem>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
 
+// row i of an Item_table
 struct Item {
-    std::string name;
-    int iid;
-    double value;
+    const my::Item_table& table;
+    std::uint32_t i;
 };
 
 std::ostream& operator<<(std::ostream& os, const Item& item)
 {
     return os
         << '('
-            << item.name
+            << item.table.name(item.i)
             << ','
-            << item.iid
+            << item.table.iid(item.i)
             << ','
-            << item.value
+            << item.table.value(item.i)
         << ')';
 }
 
-std::istream& operator>>(std::istream& is, Item& item)
+// the rows of items in the order of vi
+void print(const my::Item_table& items, const std::vector<std::uint32_t>& vi)
 {
-    std::string name;
-    int iid;
-    double value;
+    for(auto i : vi) std::cout << Item{items, i} << std::endl;
+}
 
-    char paren1, delim1, delim2, paren2;
-    is >> paren1 >> name >> delim1 >> iid >> delim2 >> value >> paren2;
-    if(!is) return is;
-    if(paren1!='(' || delim1!=',' || delim2!=',' || paren2!=')') {
-        is.clear(std::ios_base::failbit);
-        return is;
+// drill1.txt parsed, or its snapshot when that is newer
+my::Item_table load_items(const std::string& text, const std::string& snapshot)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if(fs::last_write_time(snapshot, ec) >= fs::last_write_time(text) && !ec) {
+        try {
+            return my::Item_table::open_snapshot(snapshot);
+        }
+        catch(std::runtime_error&) {
+            // stale or damaged: parse the text again
+        }
     }
-    item = Item{name, iid, value};
-
-    return is;
+    my::Mapped_file f {text};
+    my::Item_table t = my::load_items(f.view());
+    // only a cache: without it the next run parses the text again
+    try {
+        t.save_snapshot(snapshot);
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << "warning: " << e.what() << std::endl;
+    }
+    return t;
 }
 
 int main()
+try
 {
-    std::ifstream ifile("drill1.txt");
-    if(!ifile) {
-        std::cerr << "Failed to open [drill1.txt]" << std::endl;
-        return -1;
-    }
+    my::Item_table items = load_items("drill1.txt", "drill1.items");
 
-    std::vector<Item> vi;
-    Item item{};
+    // the items are never moved; vi is the order to show them in
+    std::vector<std::uint32_t> vi;
 
     std::cout << "1. fill vector<Item> with items from the file" << std::endl;
-    while(ifile >> item)
-        vi.push_back(item);
-    for(auto item : vi) std::cout << item << std::endl;
+    for(std::uint32_t i = 0; i < items.size(); ++i)
+        vi.push_back(i);
+    print(items, vi);
 
     std::cout << "2. sort vector<Item> by name" << std::endl;
-    std::sort(std::begin(vi), std::end(vi),
-        [](const Item& a, const Item& b){ return a.name < b.name; }
-    );
-    for(auto item : vi) std::cout << item << std::endl;
+    vi = items.by_name();
+    print(items, vi);
 
     std::cout << "3. sort vector<Item> by iid" << std::endl;
-    std::sort(std::begin(vi), std::end(vi),
-        [](const Item& a, const Item& b){ return a.iid < b.iid; }
-    );
-    for(auto item : vi) std::cout << item << std::endl;
+    vi = items.by_iid();
+    print(items, vi);
 
     std::cout << "4. sort vector<Item> by value in descending" << std::endl;
-    std::sort(std::begin(vi), std::end(vi),
-        [](const Item& a, const Item& b){ return a.value > b.value; }
-    );
-    for(auto item : vi) std::cout << item << std::endl;
+    vi.assign(items.by_value().rbegin(), items.by_value().rend());
+    print(items, vi);
 
     std::cout << "5. insert two items" << std::endl;
-    vi.push_back(Item{"horse shoe",99,12.34});
-    vi.push_back(Item{"Canon S400", 9988,499.95});
-    for(auto item : vi) std::cout << item << std::endl;
+    items.push_back("horse shoe",99,12.34);
+    vi.push_back(items.size() - 1);
+    items.push_back("Canon S400", 9988,499.95);
+    vi.push_back(items.size() - 1);
+    print(items, vi);
 
     std::cout << "6. remove an item identified by name : ";
     std::string name;
     while(std::cin >> name) {
-        for(auto it = vi.begin(); it != vi.end(); )
-            it->name == name ? it = vi.erase(it) : ++it;
+        // only mark them: compacting would move the items vi refers to
+        items.erase_names({name}, my::Item_table::Erase::tombstone);
         std::cout << "6. remove an item identified by name : ";
     }
     std::cout << "[quit]" << std::endl;
-    for(auto item : vi) std::cout << item << std::endl;
+    vi.erase(std::remove_if(vi.begin(), vi.end(),
+        [&](std::uint32_t i){ return items.erased(i); }), vi.end());
+    print(items, vi);
 
 
     return 0;
+}
+catch(std::exception& e) {
+    std::cerr << "Failed to read [drill1.txt]: " << e.what() << std::endl;
+    return -1;
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "item_table.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+#include <cstdlib>
+
+// the drill1.cpp way, for comparison
+struct Item {
+    std::string name;
+    int iid;
+    double value;
+};
+
+std::istream& operator>>(std::istream& is, Item& item)
+{
+    std::string name;
+    int iid;
+    double value;
+    char paren1, delim1, delim2, paren2;
+    is >> paren1 >> name >> delim1 >> iid >> delim2 >> value >> paren2;
+    if(!is) return is;
+    if(paren1!='(' || delim1!=',' || delim2!=',' || paren2!=')') {
+        is.clear(std::ios_base::failbit);
+        return is;
+    }
+    item = Item{name, iid, value};
+    return is;
+}
+
+template<typename F>
+void time_it(const std::string& name, F f)
+{
+    using namespace std::chrono;
+    auto t1 = steady_clock::now();
+    f();
+    auto t2 = steady_clock::now();
+    std::cout << name << duration<double>(t2 - t1).count() << " s\n";
+}
+
+// usage: item_bench [items]
+// loads that many items (default 5'000'000) from text, then from a snapshot,
+// sorts them by each key as drill1.cpp does, and erases some by name
+int main(int argc, char* argv[])
+{
+    const std::size_t n = argc > 1 ? std::atol(argv[1]) : 5'000'000;
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string text = dir / "item_bench.txt";
+    const std::string snapshot = dir / "item_bench.items";
+    {
+        std::mt19937 gen {42};
+        std::ofstream os {text};
+        for(std::size_t i = 0; i < n; ++i)
+            os << "(item" << gen() % 1'000'000 << " , " << i << " , " << gen() % 100'000 / 100.0 << ")\n";
+    }
+    std::cout << n << " items, " << (std::filesystem::file_size(text) >> 20) << " MB of text\n";
+
+    std::vector<Item> vi;
+    time_it("ifstream >> Item:  ", [&]{
+        std::ifstream is {text};
+        for(Item item; is >> item; ) vi.push_back(item);
+    });
+
+    my::Item_table parsed;
+    time_it("load_items:        ", [&]{
+        my::Mapped_file f {text};
+        parsed = my::load_items(f.view());
+    });
+    time_it("save_snapshot:     ", [&]{ parsed.save_snapshot(snapshot); });
+
+    my::Item_table mapped;
+    time_it("open_snapshot:     ", [&]{ mapped = my::Item_table::open_snapshot(snapshot); });
+
+    assert(vi.size() == n && parsed.size() == n && mapped.size() == n);
+    for(std::size_t i = 0; i < n; ++i) {
+        assert(parsed.name(i) == vi[i].name && mapped.name(i) == vi[i].name);
+        assert(parsed.iid(i) == vi[i].iid && mapped.iid(i) == vi[i].iid);
+        assert(parsed.value(i) == vi[i].value && mapped.value(i) == vi[i].value);
+    }
+
+    time_it("sort vector<Item> by name, iid, value: ", [&]{
+        std::sort(vi.begin(), vi.end(), [](const Item& a, const Item& b){ return a.name < b.name; });
+        std::sort(vi.begin(), vi.end(), [](const Item& a, const Item& b){ return a.iid < b.iid; });
+        std::sort(vi.begin(), vi.end(), [](const Item& a, const Item& b){ return a.value < b.value; });
+    });
+    time_it("by_name(), by_iid(), by_value():      ", [&]{
+        mapped.by_name();
+        mapped.by_iid();
+        mapped.by_value();
+    });
+    for(std::size_t i = 1; i < n; ++i) {
+        assert(mapped.name(mapped.by_name()[i-1]) <= mapped.name(mapped.by_name()[i]));
+        assert(mapped.iid(mapped.by_iid()[i-1]) <= mapped.iid(mapped.by_iid()[i]));
+        assert(mapped.value(mapped.by_value()[i-1]) <= mapped.value(mapped.by_value()[i]));
+    }
+
+    // names of some items, the first 100 of them distinct
+    std::vector<std::string> names;
+    for(std::size_t i = 0; i < n && names.size() < 100'000; i += 7)
+        names.push_back(vi[i].name);
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    std::shuffle(names.begin(), names.end(), std::mt19937{7});
+    const std::vector<std::string_view> some(names.begin(), names.begin() + std::min<std::size_t>(100, names.size()));
+    const std::vector<std::string_view> many(names.begin(), names.end());
+
+    time_it("erase 100 names one at a time:  ", [&]{
+        for(auto name : some)
+            vi.erase(std::remove_if(vi.begin(), vi.end(),
+                [&](const Item& item){ return item.name == name; }), vi.end());
+    });
+    my::Item_table copy = my::Item_table::open_snapshot(snapshot);
+    std::size_t erased = 0;
+    time_it("erase_names(100 names):         ", [&]{ erased = parsed.erase_names(some); });
+    assert(parsed.size() == vi.size() && parsed.size() + erased == n);
+    time_it("erase_names(" + std::to_string(many.size()) + " names):      ", [&]{ copy.erase_names(many); });
+    time_it("... by tombstone, then compact: ", [&]{
+        mapped.erase_names(many, my::Item_table::Erase::tombstone);
+        mapped.compact();
+    });
+    assert(copy.size() == mapped.size());
+
+    // items erased by tombstone must not come back through a snapshot
+    my::Item_table marked = my::Item_table::open_snapshot(snapshot);
+    marked.erase_names(some, my::Item_table::Erase::tombstone);
+    const std::string resaved = dir / "item_bench_erased.items";
+    marked.save_snapshot(resaved);
+    {
+        my::Item_table reopened = my::Item_table::open_snapshot(resaved);
+        assert(reopened.size() == marked.live() && reopened.size() == parsed.size());
+        for(std::size_t i = 0; i < reopened.size(); ++i) {
+            assert(std::find(some.begin(), some.end(), reopened.name(i)) == some.end());
+            assert(reopened.name(i) == parsed.name(i) && reopened.iid(i) == parsed.iid(i)
+                && reopened.value(i) == parsed.value(i));
+        }
+    }
+    std::filesystem::remove(resaved);
+
+    // saved over the file it maps: the table still reads the old one
+    marked.save_snapshot(snapshot);
+    {
+        my::Item_table reopened = my::Item_table::open_snapshot(snapshot);
+        assert(reopened.size() == marked.live());
+        for(std::size_t i = 0, j = 0; i < marked.size(); ++i)
+            if(!marked.erased(i)) {
+                assert(reopened.name(j) == marked.name(i) && reopened.iid(j) == marked.iid(i));
+                ++j;
+            }
+    }
+
+    std::filesystem::remove(text);
+    std::filesystem::remove(snapshot);
+}
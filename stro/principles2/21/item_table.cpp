@@ -0,0 +1,366 @@
+#include "item_table.h"
+#include "../tokenizer.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace my {
+
+namespace {
+
+// a snapshot file, in native byte order:
+//     Snapshot_header
+//     int32_t iids[count]
+//     padding to 8 bytes
+//     double values[count]
+//     names: count times a uint32_t length and that many chars
+struct Snapshot_header {
+    char magic[8];
+    std::uint64_t count;
+    std::uint64_t name_bytes;
+};
+
+constexpr char snapshot_magic[8] = {'I', 'T', 'E', 'M', 'S', 0, 0, 1};
+
+std::size_t values_offset(std::uint64_t count)
+{
+    std::size_t off = sizeof(Snapshot_header) + count * sizeof(std::int32_t);
+    return (off + 7) & ~std::size_t{7};
+}
+
+// a sort key and the item it belongs to
+template<typename K>
+struct Keyed {
+    K key;
+    std::uint32_t index;
+};
+
+/*
+ * LSD radix sort on the bytes of key, least significant first.
+ * Each pass is stable, and passes where every key has the same byte
+ * are skipped, so small iids cost one or two passes rather than four.
+ */
+template<typename K>
+std::vector<std::uint32_t> radix_order(std::vector<Keyed<K>>& v)
+{
+    constexpr int passes = sizeof(K);
+    std::vector<std::size_t> count(passes * 256);
+    for(const auto& x : v)
+        for(int b = 0; b < passes; ++b)
+            ++count[b * 256 + ((x.key >> 8 * b) & 0xFF)];
+
+    std::vector<Keyed<K>> tmp(v.size());
+    for(int b = 0; b < passes && !v.empty(); ++b) {
+        std::size_t* c = &count[b * 256];
+        if(c[(v[0].key >> 8 * b) & 0xFF] == v.size()) continue;
+        std::size_t at = 0;
+        for(int d = 0; d < 256; ++d)
+            at += std::exchange(c[d], at);
+        for(const auto& x : v)
+            tmp[c[(x.key >> 8 * b) & 0xFF]++] = x;
+        v.swap(tmp);
+    }
+
+    std::vector<std::uint32_t> order(v.size());
+    for(std::size_t i = 0; i < v.size(); ++i)
+        order[i] = v[i].index;
+    return order;
+}
+
+// keys whose unsigned order is the order of the value
+std::uint32_t radix_key(std::int32_t i)
+{
+    return std::uint32_t(i) ^ 0x80000000u;
+}
+
+std::uint64_t radix_key(double d)
+{
+    std::uint64_t u;
+    std::memcpy(&u, &d, sizeof(u));
+    return u >> 63 ? ~u : u | 0x8000000000000000u;
+}
+
+template<typename T>
+std::vector<std::uint32_t> radix_order(const T* col, std::size_t n)
+{
+    std::vector<Keyed<decltype(radix_key(T{}))>> v(n);
+    for(std::size_t i = 0; i < n; ++i)
+        v[i] = {radix_key(col[i]), std::uint32_t(i)};
+    return radix_order(v);
+}
+
+} // namespace
+
+void Item_table::changed()
+{
+    name_order.clear();
+    iid_order.clear();
+    value_order.clear();
+}
+
+namespace {
+
+std::vector<std::uint32_t>& drop_erased(std::vector<std::uint32_t>& order, const Item_table& t)
+{
+    if(t.live() != t.size())
+        order.erase(std::remove_if(order.begin(), order.end(),
+            [&](std::uint32_t i){ return t.erased(i); }), order.end());
+    return order;
+}
+
+} // namespace
+
+const std::vector<std::uint32_t>& Item_table::by_name() const
+{
+    if(!name_order.empty() || live() == 0) return name_order;
+
+    // radix sort on the first 8 bytes, big-endian so that unsigned order
+    // is string order, then sort the runs that tie on them by whole name
+    std::vector<Keyed<std::uint64_t>> v(size());
+    for(std::size_t i = 0; i < size(); ++i) {
+        std::string_view s = name(i);
+        std::uint64_t k = 0;
+        for(std::size_t j = 0; j < 8; ++j)
+            k = k << 8 | (j < s.size() ? static_cast<unsigned char>(s[j]) : 0);
+        v[i] = {k, std::uint32_t(i)};
+    }
+    std::vector<std::uint64_t> prefix(size());
+    for(std::size_t i = 0; i < size(); ++i) prefix[v[i].index] = v[i].key;
+    name_order = radix_order(v);
+
+    for(auto p = name_order.begin(); p != name_order.end(); ) {
+        auto q = p + 1;
+        while(q != name_order.end() && prefix[*q] == prefix[*p]) ++q;
+        if(q - p > 1)
+            std::sort(p, q, [&](std::uint32_t a, std::uint32_t b){ return name(a) < name(b); });
+        p = q;
+    }
+    return drop_erased(name_order, *this);
+}
+
+const std::vector<std::uint32_t>& Item_table::by_iid() const
+{
+    if(iid_order.empty() && live() != 0) {
+        iid_order = radix_order(iids, size());
+        drop_erased(iid_order, *this);
+    }
+    return iid_order;
+}
+
+const std::vector<std::uint32_t>& Item_table::by_value() const
+{
+    if(value_order.empty() && live() != 0) {
+        value_order = radix_order(values, size());
+        drop_erased(value_order, *this);
+    }
+    return value_order;
+}
+
+void Item_table::refresh()
+{
+    names = name_col.data();
+    iids = iid_col.data();
+    values = value_col.data();
+}
+
+void Item_table::own()
+{
+    if(!snapshot) return;
+    const std::size_t n = size();
+    const char* name_first = names;
+    const char* name_last = snapshot->data() + snapshot->size();
+    name_col.assign(name_first, name_last);
+    iid_col.assign(iids, iids + n);
+    value_col.assign(values, values + n);
+    snapshot.reset();
+    refresh();
+}
+
+void Item_table::reserve(std::size_t n, std::size_t name_bytes)
+{
+    own();
+    name_col.reserve(name_bytes + n * sizeof(std::uint32_t));
+    iid_col.reserve(n);
+    value_col.reserve(n);
+    name_at.reserve(n);
+    refresh();
+}
+
+void Item_table::push_back(std::string_view name, int iid, double value)
+{
+    own();
+    const std::uint32_t n = name.size();
+    name_at.push_back(name_col.size());
+    const char* len = reinterpret_cast<const char*>(&n);
+    name_col.insert(name_col.end(), len, len + sizeof(n));
+    name_col.insert(name_col.end(), name.begin(), name.end());
+    iid_col.push_back(iid);
+    value_col.push_back(value);
+    if(n_dead) dead.push_back(false);
+    refresh();
+    changed();
+}
+
+std::size_t Item_table::erase_names(const std::vector<std::string_view>& names, Erase how)
+{
+    const std::unordered_set<std::string_view> doomed(names.begin(), names.end());
+    if(dead.empty()) dead.resize(size());
+
+    std::size_t n = 0;
+    for(std::size_t i = 0; i < size(); ++i)
+        if(!dead[i] && doomed.count(name(i))) {
+            dead[i] = true;
+            ++n;
+        }
+    n_dead += n;
+
+    if(how == Erase::compact) compact();
+    else if(n) changed();
+    if(n_dead == 0) dead.clear();
+    return n;
+}
+
+void Item_table::compact()
+{
+    if(n_dead == 0) return;
+    own();
+
+    // like remove_if, but over the three columns at once
+    std::size_t w = 0;
+    std::uint64_t at = 0;
+    for(std::size_t r = 0; r < size(); ++r) {
+        if(dead[r]) continue;
+        const std::size_t len = sizeof(std::uint32_t) + name(r).size();
+        std::memmove(&name_col[at], &name_col[name_at[r]], len);
+        name_at[w] = at;
+        iid_col[w] = iid_col[r];
+        value_col[w] = value_col[r];
+        at += len;
+        ++w;
+    }
+    name_col.resize(at);
+    name_at.resize(w);
+    iid_col.resize(w);
+    value_col.resize(w);
+    dead.clear();
+    n_dead = 0;
+    refresh();
+    changed();
+}
+
+void Item_table::save_snapshot(const std::string& path) const
+{
+    // written beside path and renamed over it, so that path is never half
+    // written and a table mapping the old file keeps reading it
+    const std::string tmp = path + ".tmp";
+    std::ofstream os {tmp, std::ios_base::binary | std::ios_base::trunc};
+    if(!os) throw std::runtime_error{"cannot write " + tmp};
+
+    // items erased by tombstone are left out, as compact() would leave them
+    const std::size_t n = live();
+    std::size_t name_bytes = 0;
+    if(n_dead == 0)
+        name_bytes = n ? (snapshot ? snapshot->size() - (names - snapshot->data())
+                                   : name_col.size())
+                       : 0;
+    else
+        for(std::size_t i = 0; i < size(); ++i)
+            if(!dead[i]) name_bytes += sizeof(std::uint32_t) + name(i).size();
+
+    Snapshot_header h {};
+    std::memcpy(h.magic, snapshot_magic, sizeof(h.magic));
+    h.count = n;
+    h.name_bytes = name_bytes;
+
+    // each column in one write, or a live row at a time
+    const auto write_column = [&](const char* col, std::size_t width) {
+        if(n_dead == 0) {
+            os.write(col, n * width);
+            return;
+        }
+        for(std::size_t i = 0; i < size(); ++i)
+            if(!dead[i]) os.write(col + i * width, width);
+    };
+
+    const char pad[8] {};
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    write_column(reinterpret_cast<const char*>(iids), sizeof(std::int32_t));
+    os.write(pad, values_offset(n) - sizeof(h) - n * sizeof(std::int32_t));
+    write_column(reinterpret_cast<const char*>(values), sizeof(double));
+    if(n_dead == 0)
+        os.write(names, name_bytes);
+    else
+        for(std::size_t i = 0; i < size(); ++i)
+            if(!dead[i]) os.write(names + name_at[i], sizeof(std::uint32_t) + name(i).size());
+    os.close();
+    if(!os) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error{"cannot write " + tmp};
+    }
+    if(std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error{"cannot rename " + tmp + " to " + path};
+    }
+}
+
+Item_table Item_table::open_snapshot(const std::string& path)
+{
+    Mapped_file f {path};
+    const auto bad = [&]{ return std::runtime_error{path + ": not an item snapshot"}; };
+
+    Snapshot_header h;
+    if(f.size() < sizeof(h)) throw bad();
+    std::memcpy(&h, f.data(), sizeof(h));
+    // each part no bigger than the file before they are added, so that
+    // a bad header cannot make the sum wrap
+    if(std::memcmp(h.magic, snapshot_magic, sizeof(h.magic)) != 0
+        || h.count > f.size() / (sizeof(std::int32_t) + sizeof(double))
+        || h.name_bytes > f.size()
+        || values_offset(h.count) + h.count * sizeof(double) + h.name_bytes != f.size())
+        throw bad();
+
+    Item_table t;
+    t.iids = reinterpret_cast<const std::int32_t*>(f.data() + sizeof(h));
+    t.values = reinterpret_cast<const double*>(f.data() + values_offset(h.count));
+    t.names = f.data() + values_offset(h.count) + h.count * sizeof(double);
+
+    // the names have no index on disk; one pass builds it
+    t.name_at.reserve(h.count);
+    std::uint64_t at = 0;
+    for(std::uint64_t i = 0; i < h.count; ++i) {
+        std::uint32_t n;
+        if(h.name_bytes - at < sizeof(n)) throw bad();
+        std::memcpy(&n, t.names + at, sizeof(n));
+        if(h.name_bytes - at - sizeof(n) < n) throw bad();
+        t.name_at.push_back(at);
+        at += sizeof(n) + n;
+    }
+    if(at != h.name_bytes) throw bad();
+
+    t.snapshot.emplace(std::move(f));
+    return t;
+}
+
+Item_table load_items(std::string_view text)
+{
+    Item_table t;
+    t.reserve(text.size() / 24, text.size() / 3);
+
+    Token_reader is {text};
+    for(;;) {
+        std::string_view name;
+        int iid = 0;
+        double value = 0;
+        char paren1 = 0, delim1 = 0, delim2 = 0, paren2 = 0;
+        is >> paren1 >> name >> delim1 >> iid >> delim2 >> value >> paren2;
+        if(!is || paren1!='(' || delim1!=',' || delim2!=',' || paren2!=')')
+            break;
+        t.push_back(name, iid, value);
+    }
+    return t;
+}
+
+} // namespace my
@@ -0,0 +1,102 @@
+#ifndef MY_ITEM_TABLE_H
+#define MY_ITEM_TABLE_H
+
+#include "../mapped_file.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+
+namespace my {
+
+/**
+ * (name, iid, value) records stored by column.
+ * Names are kept back to back, each after its 32-bit length, which is
+ * also how a snapshot file lays them out; name_at[i] is where item i's
+ * length is. A table opened from a snapshot reads the mapped file
+ * directly and copies it into its own columns only when changed.
+ */
+class Item_table {
+    std::vector<char> name_col;
+    std::vector<std::int32_t> iid_col;
+    std::vector<double> value_col;
+    std::vector<std::uint64_t> name_at;
+    std::optional<Mapped_file> snapshot;
+
+    // what the accessors read: the columns above, or the snapshot
+    const char* names = nullptr;
+    const std::int32_t* iids = nullptr;
+    const double* values = nullptr;
+
+    // item indices sorted by each key; empty until asked for
+    mutable std::vector<std::uint32_t> name_order;
+    mutable std::vector<std::uint32_t> iid_order;
+    mutable std::vector<std::uint32_t> value_order;
+
+    std::vector<bool> dead;         // tombstones; empty if there are none
+    std::size_t n_dead = 0;
+
+    void refresh();
+    void own();
+    void changed();
+public:
+    enum class Erase {
+        compact,        // remove the items at once
+        tombstone,      // only mark them, until compact()
+    };
+
+    Item_table() = default;
+
+    // items, counting those erased by tombstone
+    std::size_t size() const { return name_at.size(); }
+    std::size_t live() const { return size() - n_dead; }
+    bool erased(std::size_t i) const { return n_dead && dead[i]; }
+
+    std::string_view name(std::size_t i) const
+    {
+        const char* p = names + name_at[i];
+        std::uint32_t n;
+        std::memcpy(&n, p, sizeof(n));
+        return {p + sizeof(n), n};
+    }
+    int iid(std::size_t i) const { return iids[i]; }
+    double value(std::size_t i) const { return values[i]; }
+
+    /*
+     * Permutation views: indices of the live items in ascending order
+     * of a key. Each is sorted when first asked for, iid and value by
+     * radix sort, and is forgotten when the table changes; no item moves.
+     */
+    const std::vector<std::uint32_t>& by_name() const;
+    const std::vector<std::uint32_t>& by_iid() const;
+    const std::vector<std::uint32_t>& by_value() const;
+
+    void reserve(std::size_t n, std::size_t name_bytes = 0);
+    void push_back(std::string_view name, int iid, double value);
+
+    /*
+     * Erases every item whose name is one of names and returns how many.
+     * The names go into a hash set, each item is looked up once, and the
+     * columns are compacted in a single pass, which shifts the indices of
+     * later items; Erase::tombstone defers that until compact().
+     */
+    std::size_t erase_names(const std::vector<std::string_view>& names, Erase how = Erase::compact);
+    void compact();
+
+    // writes the live items only, so erased ones do not come back, to
+    // path + ".tmp" and renames that over path
+    void save_snapshot(const std::string& path) const;
+    static Item_table open_snapshot(const std::string& path);
+};
+
+/**
+ * Parses "(name , iid , value)" records, as operator>>(istream&, Item&)
+ * in drill1.cpp does, up to the first one that does not parse.
+ */
+Item_table load_items(std::string_view text);
+
+} // namespace my
+
+#endif
@@ -0,0 +1,85 @@
+#include "column.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+
+// unlike assert, still checks with NDEBUG, which a benchmark is built with
+void check(bool ok, const char* what)
+{
+    if(!ok) throw std::runtime_error{std::string{"column: "} + what};
+}
+
+template<typename F>
+void time_it(const char* name, std::size_t bytes, F f)
+{
+    using namespace std::chrono;
+    auto t1 = steady_clock::now();
+    f();
+    auto t2 = steady_clock::now();
+    double s = duration<double>(t2 - t1).count();
+    std::cout << name << s << " s, " << bytes / s / (1 << 20) << " MB/s\n";
+}
+
+template<typename T>
+void bench(const char* type, const std::string& text, std::size_t n)
+{
+    std::cout << n << ' ' << type << "s, " << (text.size() >> 20) << " MB\n";
+
+    std::vector<T> a, b, c;
+    a.reserve(n);
+    b.reserve(n);
+    c.reserve(n);
+    std::size_t parsed = 0;
+    time_it("  parse_column:   ", text.size(), [&]{
+        parsed = my::parse_column(text, a).value();
+    });
+    check(parsed == n, "parse_column count");
+    time_it("  to<>() per line: ", text.size(), [&]{
+        std::string_view s = text;
+        for(std::size_t p; (p = s.find('\n')) != s.npos; s.remove_prefix(p + 1))
+            b.push_back(my::to<T>(s.substr(0, p)).value());
+    });
+    time_it("  istream >> x:    ", text.size(), [&]{
+        std::istringstream is {text};
+        for(T x; is >> x; ) c.push_back(x);
+    });
+    check(a == b, "parse_column and to<>() differ");
+    check(a == c, "parse_column and istream differ");
+}
+
+int main()
+{
+    using my::To_error;
+    std::vector<int> vi;
+    check(my::parse_column("1\n -22 \n+333\n4444\n", vi).value() == 4, "int count");
+    check((vi == std::vector<int>{1, -22, 333, 4444}), "int values");
+    auto e1 = my::parse_column("1,2,123.4,5", vi, ',');
+    check(!e1 && e1.error().error == To_error::trailing && e1.error().field == 2, "trailing field");
+    check(my::parse_column("2147483648", vi).error().error == To_error::out_of_range, "out of range");
+    check(my::parse_column("-2147483648", vi).value() == 1 && vi.back() == -2147483648, "INT_MIN");
+    check(my::parse_column("1\n\n2", vi).error().field == 1, "empty field");
+    std::vector<double> vd;
+    check(my::parse_column("1.5 2e3 -.25 0.1", vd, ' ').value() == 4, "double count");
+    check(vd[1] == 2000 && vd[2] == -0.25 && vd[3] == 0.1, "double values");
+    check(my::parse_column("inf", vd).error().error == To_error::invalid, "inf");
+
+    constexpr std::size_t n = 10'000'000;
+    std::mt19937_64 gen {42};
+    std::string ints, doubles;
+    std::uniform_int_distribution<int> di {-1'000'000'000, 1'000'000'000};
+    std::uniform_real_distribution<double> dd {-1e6, 1e6};
+    for(std::size_t i = 0; i < n; ++i) {
+        ints += std::to_string(di(gen));
+        ints += '\n';
+        char buf[32];
+        auto r = std::to_chars(buf, buf + sizeof(buf), dd(gen), std::chars_format::fixed, 3);
+        doubles.append(buf, r.ptr);
+        doubles += '\n';
+    }
+    bench<int>("int", ints, n);
+    bench<double>("double", doubles, n);
+}
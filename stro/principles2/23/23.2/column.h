@@ -0,0 +1,250 @@
+#ifndef MY_COLUMN_H
+#define MY_COLUMN_H
+
+#include "to.h"
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace my {
+
+// why field (0-based) of a column could not be converted
+struct Column_error {
+    To_error error;
+    std::size_t field;
+};
+
+inline std::string message(const Column_error& e)
+{
+    return std::string{message(e.error)} + " at field " + std::to_string(e.field);
+}
+
+namespace column_impl {
+
+/*
+ * Eight characters at a time in a 64-bit word (SWAR),
+ * the first character in the lowest byte.
+ */
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "column.h assumes little-endian words");
+
+constexpr std::uint64_t ones = 0x0101010101010101;
+
+// the 8 bytes at p, or those before last followed by zeros
+inline std::uint64_t load8(const char* p, const char* last)
+{
+    std::uint64_t x = 0;
+    if(last - p >= 8)
+        std::memcpy(&x, p, 8);
+    else
+        for(int i = 0; p + i < last; ++i)
+            x |= std::uint64_t(static_cast<unsigned char>(p[i])) << 8 * i;
+    return x;
+}
+
+// how many of the leading bytes of x are '0'..'9'
+inline int leading_digits(std::uint64_t x)
+{
+    // a digit byte is 0x3X with X+6 still below 0x10, i.e. 0x33 below
+    std::uint64_t v = (x & (0xF0 * ones)) | (((x + 0x06 * ones) & (0xF0 * ones)) >> 4);
+    std::uint64_t bad = v ^ (0x33 * ones);
+    return bad ? __builtin_ctzll(bad) / 8 : 8;
+}
+
+// the value of 8 digit characters, the first one the most significant
+inline std::uint32_t parse8(std::uint64_t x)
+{
+    x -= 0x30 * ones;
+    x = x * 10 + (x >> 8);
+    x = ((x & 0x000000FF000000FF) * (100 + (1000000ULL << 32))
+        + ((x >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))) >> 32;
+    return static_cast<std::uint32_t>(x);
+}
+
+// the value of the first 1 <= n <= 8 characters of x, all digits
+inline std::uint32_t parse_first(std::uint64_t x, int n)
+{
+    // shift out the rest and pad with '0's in front
+    const int s = 8 * (8 - n);
+    if(s) x = x << s | ((0x30 * ones) & ((1ULL << s) - 1));
+    return parse8(x);
+}
+
+// the number of digits at [p:last)
+inline std::size_t count_digits(const char* p, const char* last)
+{
+    std::size_t n = 0;
+    for(;;) {
+        int k = leading_digits(load8(p + n, last));
+        n += k;
+        if(k < 8 || p + n >= last) return n;
+    }
+}
+
+// the value of the n <= 19 digits at [p:last)
+inline std::uint64_t parse_digits(const char* p, std::size_t n, const char* last)
+{
+    std::uint64_t v = 0;
+    std::size_t head = n % 8;
+    if(head) v = parse_first(load8(p, last), head);
+    for(std::size_t i = head; i < n; i += 8)
+        v = v * 100000000 + parse8(load8(p + i, last));
+    return v;
+}
+
+inline bool is_space(char c)
+{
+    return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+/*
+ * The number at p, as from_chars() would read it but also taking a
+ * leading '+'; p is left just after it. On failure, returns the error.
+ */
+template<typename T>
+std::optional<To_error> parse_int(const char*& p, const char* last, T& v)
+{
+    bool negative = false;
+    if(p != last && *p == '+') ++p;
+    else if(p != last && *p == '-') {
+        if constexpr(std::is_unsigned_v<T>) return To_error::invalid;
+        negative = true;
+        ++p;
+    }
+
+    // most numbers have at most 7 digits: one load does
+    const std::uint64_t x = load8(p, last);
+    const int k = leading_digits(x);
+    const std::size_t n = k < 8 ? k : count_digits(p, last);
+    if(n == 0) return To_error::invalid;
+
+    if(n <= 19) {
+        using U = std::make_unsigned_t<T>;
+        const std::uint64_t u = k < 8 ? parse_first(x, k) : parse_digits(p, n, last);
+        const std::uint64_t limit = std::uint64_t(std::numeric_limits<T>::max()) + negative;
+        if(u > limit) return To_error::out_of_range;
+        v = negative ? static_cast<T>(U(0) - U(u)) : static_cast<T>(u);
+    }
+    else {
+        // leading zeros, or out of range: rare enough for from_chars
+        auto [q, ec] = std::from_chars(negative ? p - 1 : p, p + n, v);
+        if(ec != std::errc{}) return To_error::out_of_range;
+    }
+    p += n;
+    return {};
+}
+
+// 10^0 .. 10^22 are exact in a double
+constexpr double exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+template<typename T>
+std::optional<To_error> parse_float(const char*& p, const char* last, T& v)
+{
+    if(p != last && *p == '+') {
+        ++p;
+        if(p != last && *p == '-') return To_error::invalid;
+    }
+    const char* first = p;
+    const bool negative = p != last && *p == '-';
+    const char* q = negative ? p + 1 : p;
+
+    // [int][.frac][e[+-]exp], the part from_chars would read
+    const char* int_part = q;
+    const std::size_t n_int = count_digits(q, last);
+    q += n_int;
+    const char* frac = q;
+    std::size_t n_frac = 0;
+    if(q != last && *q == '.') {
+        frac = ++q;
+        n_frac = count_digits(q, last);
+        q += n_frac;
+    }
+    if(n_int + n_frac == 0) return To_error::invalid;
+    long exp = 0;
+    bool big_exp = false;
+    if(q != last && (*q == 'e' || *q == 'E')) {
+        const char* r = q + 1;
+        bool exp_negative = false;
+        if(r != last && (*r == '+' || *r == '-')) exp_negative = *r++ == '-';
+        const std::size_t n_exp = count_digits(r, last);
+        if(n_exp) {
+            big_exp = n_exp > 4;
+            if(!big_exp) exp = parse_digits(r, n_exp, last);
+            if(exp_negative) exp = -exp;
+            q = r + n_exp;
+        }
+    }
+
+    // Clinger's fast path: an exact mantissa times an exact power of 10
+    // rounds once, so the result is correctly rounded
+    if(std::is_same_v<T, double> && !big_exp && n_int + n_frac <= 15) {
+        std::uint64_t m = n_int ? parse_digits(int_part, n_int, last) : 0;
+        if(n_frac) m = m * std::uint64_t(exact_pow10[n_frac]) + parse_digits(frac, n_frac, last);
+        const long e = exp - long(n_frac);
+        if(-22 <= e && e <= 22) {
+            double d = double(m);
+            d = e < 0 ? d / exact_pow10[-e] : d * exact_pow10[e];
+            v = negative ? -d : d;
+            p = q;
+            return {};
+        }
+    }
+
+    auto [r, ec] = std::from_chars(first, q, v);
+    if(ec == std::errc::result_out_of_range) return To_error::out_of_range;
+    if(ec != std::errc{} || r != q) return To_error::invalid;
+    p = q;
+    return {};
+}
+
+} // namespace column_impl
+
+/**
+ * Converts every delim-separated field of text to a T and appends it to out.
+ * Each field is checked as to<T>() checks a whole string: whitespace around
+ * the number is fine, anything else (e.g. "123.4" for an int) is an error.
+ * A last field of only whitespace, as after a final newline, is ignored.
+ * On error, out holds the fields before the bad one.
+ */
+template<typename T>
+Expected<std::size_t, Column_error> parse_column(std::string_view text, std::vector<T>& out, char delim = '\n')
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "parse_column: ints and doubles only");
+    using namespace column_impl;
+    const char* p = text.data();
+    const char* const last = p + text.size();
+    const std::size_t first = out.size();
+    auto blank = [&](char c){ return c != delim && is_space(c); };
+
+    for(std::size_t field = 0; ; ++field) {
+        while(p != last && blank(*p)) ++p;
+        if(p == last) break;
+
+        T v;
+        std::optional<To_error> e;
+        if constexpr(std::is_floating_point_v<T>)
+            e = parse_float(p, last, v);
+        else
+            e = parse_int(p, last, v);
+        if(e) return Column_error{*e, field};
+
+        while(p != last && blank(*p)) ++p;
+        if(p != last && *p != delim) return Column_error{To_error::trailing, field};
+        out.push_back(v);
+        if(p == last) break;
+        ++p;
+    }
+    return out.size() - first;
+}
+
+} // namespace my
+
+#endif
@@ -1,28 +1,40 @@
-#include <sstream>
-#include <exception>
+#include "to.h"
 #include <iostream>
+#include <cassert>
 
-template<typename Target, typename Source>
-Target to(Source arg)
-{
-    std::stringstream interpreter;
-    Target result;
-
-    if(!(interpreter << arg)
-        || !(interpreter >> result)
-        || !(interpreter >> std::ws).eof())
-            throw std::runtime_error{"to<>() failed"};
+struct Point { int x, y; };
 
-    std::cout << result << std::endl;
-    return result;
+std::ostream& operator<<(std::ostream& os, const Point& p)
+{
+    return os << '(' << p.x << ',' << p.y << ')';
 }
 
 int main()
-try
 {
-    int i1 = to<int>("123 ");
-    int i2 = to<int>("123.4");
+    auto i1 = my::to<int>("123 ");
+    assert(i1 && *i1 == 123);
+    std::cout << *i1 << std::endl;
+
+    auto i2 = my::to<int>("123.4");
+    assert(!i2 && i2.error() == my::To_error::trailing);
+    std::cerr << my::message(i2.error()) << std::endl;
+
+    assert(my::to<int>(" +42\n").value() == 42);
+    assert(my::to<int>("99999999999").error() == my::To_error::out_of_range);
+    assert(my::to<double>("1.5e3").value() == 1500);
+    assert(my::to<double>("inf").error() == my::To_error::invalid);
+    assert(my::to<std::string>(3.14159265).value() == "3.14159");
+    assert(my::to<std::string>("two words").error() == my::To_error::trailing);
+    assert(my::to<int>(std::string{"7"}).value() == 7);
+    assert(my::to<bool>(1).value());
+    assert(my::to<char>('x').value() == 'x');
+    assert(my::to<std::string>(Point{1, 2}).value() == "(1,2)");
+
+    try {
+        int i3 = my::to<int>("x").value();
+        std::cout << i3 << std::endl;
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+    }
 }
-catch(std::runtime_error e) {
-    std::cerr << e.what() << std::endl;
-}
\ No newline at end of file
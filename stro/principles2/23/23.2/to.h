@@ -0,0 +1,183 @@
+#ifndef MY_TO_H
+#define MY_TO_H
+
+#include <charconv>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+enum class To_error {
+    invalid,            // Source's text does not start with a Target
+    out_of_range,       // ... it does, but the value does not fit
+    trailing,           // ... it does, but more than whitespace follows
+};
+
+inline const char* message(To_error e)
+{
+    switch(e) {
+    case To_error::invalid:      return "to<>() failed: invalid";
+    case To_error::out_of_range: return "to<>() failed: out of range";
+    case To_error::trailing:     return "to<>() failed: trailing characters";
+    }
+    return "to<>() failed";
+}
+
+/**
+ * Either a T or the E that prevented one, as std::expected would be.
+ * value() throws runtime_error{message(error())} when there is no value.
+ */
+template<typename T, typename E = To_error>
+class Expected {
+    T val {};
+    E err {};
+    bool ok;
+public:
+    Expected(T v) : val{std::move(v)}, ok{true} {}
+    Expected(E e) : err{e}, ok{false} {}
+
+    bool has_value() const { return ok; }
+    explicit operator bool() const { return ok; }
+    const E& error() const { return err; }
+
+    const T& value() const&
+    {
+        if(!ok) throw std::runtime_error{message(err)};
+        return val;
+    }
+    T&& value() &&
+    {
+        if(!ok) throw std::runtime_error{message(err)};
+        return std::move(val);
+    }
+    const T& operator*() const { return val; }
+    T value_or(T v) const { return ok ? val : v; }
+};
+
+namespace to_impl {
+
+template<typename T>
+constexpr bool is_char = std::is_same_v<T, char>
+    || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+// what to_chars/from_chars handle; chars and bools are streamed differently
+template<typename T>
+constexpr bool is_number = std::is_arithmetic_v<T> && !is_char<T> && !std::is_same_v<T, bool>;
+
+template<typename T>
+constexpr bool is_text = std::is_convertible_v<const T&, std::string_view>;
+
+inline bool is_space(char c)
+{
+    return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+inline std::string_view skip_ws(std::string_view s)
+{
+    std::size_t i = 0;
+    while(i < s.size() && is_space(s[i])) ++i;
+    return s.substr(i);
+}
+
+// rest must be whitespace only, as `interpreter >> std::ws` then eof()
+template<typename T>
+Expected<T> finish(T v, std::string_view rest)
+{
+    if(!skip_ws(rest).empty()) return To_error::trailing;
+    return v;
+}
+
+// like operator>>(istream&, T&) from s, then nothing but whitespace
+template<typename T>
+Expected<T> parse(std::string_view s)
+{
+    s = skip_ws(s);
+    if constexpr(is_number<T>) {
+        const char* first = s.data();
+        const char* last = first + s.size();
+        // istream takes a leading '+', from_chars does not
+        if(first != last && *first == '+') {
+            ++first;
+            if(first != last && *first == '-') return To_error::invalid;
+        }
+        // from_chars takes "inf" and "nan", istream does not
+        const char* d = first != last && *first == '-' ? first + 1 : first;
+        if(d == last || !(('0' <= *d && *d <= '9') || *d == '.'))
+            return To_error::invalid;
+
+        T v {};
+        auto [p, ec] = std::from_chars(first, last, v);
+        if(ec == std::errc::result_out_of_range) return To_error::out_of_range;
+        if(ec != std::errc{}) return To_error::invalid;
+        return finish(v, std::string_view(p, last - p));
+    }
+    else if constexpr(std::is_same_v<T, bool>) {
+        auto i = parse<int>(s);
+        if(!i) return i.error();
+        if(*i != 0 && *i != 1) return To_error::invalid;
+        return *i == 1;
+    }
+    else if constexpr(is_char<T>) {
+        if(s.empty()) return To_error::invalid;
+        return finish(static_cast<T>(s.front()), s.substr(1));
+    }
+    else if constexpr(std::is_same_v<T, std::string>) {
+        std::size_t n = 0;
+        while(n < s.size() && !is_space(s[n])) ++n;
+        if(n == 0) return To_error::invalid;
+        return finish(std::string(s.substr(0, n)), s.substr(n));
+    }
+    else {
+        std::istringstream is {std::string(s)};
+        T v;
+        if(!(is >> v)) return To_error::invalid;
+        if(!(is >> std::ws).eof()) return To_error::trailing;
+        return v;
+    }
+}
+
+} // namespace to_impl
+
+/**
+ * Converts arg to a Target through its text, as if by
+ *     stringstream interpreter;
+ *     interpreter << arg; interpreter >> result;
+ * and requires that only whitespace follows.
+ * Numbers use to_chars/from_chars and text is read in place, so
+ * nothing is allocated unless Target is a std::string; other types
+ * still go through a stringstream.
+ */
+template<typename Target, typename Source>
+Expected<Target> to(const Source& arg)
+{
+    using namespace to_impl;
+    if constexpr(is_text<Source>) {
+        return parse<Target>(std::string_view(arg));
+    }
+    else if constexpr(is_char<Source>) {
+        const char c = static_cast<char>(arg);
+        return parse<Target>(std::string_view(&c, 1));
+    }
+    else if constexpr(std::is_arithmetic_v<Source>) {
+        char buf[64];
+        std::to_chars_result r;
+        if constexpr(std::is_floating_point_v<Source>)
+            r = std::to_chars(buf, buf + sizeof(buf), arg, std::chars_format::general, 6);    // ostream's default
+        else
+            r = std::to_chars(buf, buf + sizeof(buf), +arg);
+        return parse<Target>(std::string_view(buf, r.ptr - buf));
+    }
+    else {
+        std::ostringstream os;
+        if(!(os << arg)) return To_error::invalid;
+        return parse<Target>(os.str());
+    }
+}
+
+} // namespace my
+
+#endif
@@ -1,7 +1,8 @@
 #include "message.h"
 #include "mailfile.h"
+#include "../../interner.h"
 #include <iostream>
-#include <map>
+#include <vector>
 #include <string>
 
 using namespace my::MailLib;
@@ -10,17 +11,22 @@ using namespace std;
 int main()
 {
     Mail_file mfile {"mailfile.txt"};
-    multimap<string, const Message*> sender;
+    my::Interner senders;
+    vector<vector<const Message*>> sent;    // messages by sender id
 
     for(const auto& m : mfile) {
         string s;
-        if(find_from_addr(&m, s))
-            sender.insert(make_pair(s, &m));
+        if(find_from_addr(&m, s)) {
+            auto id = senders.intern(s);
+            if(id == sent.size()) sent.emplace_back();
+            sent[id].push_back(&m);
+        }
     }
 
-    auto pp = sender.equal_range("John Doe <jdoe@machine.example>");
-    for(auto p = pp.first; p != pp.second; ++p)
-        cout << find_subject(p->second) << endl;
+    auto id = senders.find("John Doe <jdoe@machine.example>");
+    if(id != my::Interner::npos)
+        for(auto p : sent[id])
+            cout << find_subject(p) << endl;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,123 @@
+#ifndef MY_ADDRESS_PARALLEL_SCAN_H
+#define MY_ADDRESS_PARALLEL_SCAN_H
+
+#include "zip_scanner.h"
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+namespace my {
+namespace Address {
+
+/**
+ * Splits text into chunks of about chunk_size bytes,
+ * each ending just after a '\n' (or at the end of text).
+ */
+inline std::vector<std::string_view> split_lines(std::string_view text, std::size_t chunk_size)
+{
+    std::vector<std::string_view> chunks;
+    chunk_size = std::max<std::size_t>(chunk_size, 1);
+    while(!text.empty()) {
+        std::size_t n = text.size();
+        if(chunk_size < n) {
+            std::size_t nl = text.find('\n', chunk_size - 1);
+            if(nl != std::string_view::npos) n = nl + 1;
+        }
+        chunks.push_back(text.substr(0, n));
+        text.remove_prefix(n);
+    }
+    return chunks;
+}
+
+/**
+ * scan_zipcodes() on nthreads threads (0 means one per core).
+ * Workers scan newline-aligned chunks in any order; a reorder buffer
+ * hands their matches to f, on the calling thread, in the order and
+ * with the line numbers a serial scan would give.
+ * At most a window of chunks is held ahead of f, so memory stays bounded.
+ */
+template<typename F>
+void scan_zipcodes_parallel(std::string_view text, F f,
+                            unsigned nthreads = 0, std::size_t chunk_size = 4 << 20)
+{
+    if(nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+    const auto chunks = split_lines(text, chunk_size);
+    const std::size_t window = 4 * nthreads;
+
+    struct Result {
+        std::vector<Zip_match> matches;     // lines numbered from 1 within the chunk
+        std::size_t newlines = 0;
+        bool done = false;
+    };
+    std::vector<Result> results(chunks.size());
+
+    std::mutex m;
+    std::condition_variable ready;      // a chunk is done
+    std::condition_variable room;       // the window moved on
+    std::size_t next = 0;               // the next chunk to scan
+    std::size_t emitted = 0;            // chunks handed to f so far
+
+    auto worker = [&] {
+        for(;;) {
+            std::size_t i;
+            {
+                std::unique_lock lck {m};
+                room.wait(lck, [&]{ return next >= chunks.size() || next < emitted + window; });
+                if(next >= chunks.size()) return;
+                i = next++;
+            }
+            Result r;
+            r.newlines = scan_zipcodes(chunks[i],
+                [&](const Zip_match& z){ r.matches.push_back(z); });
+            r.done = true;
+            std::scoped_lock lck {m};
+            results[i] = std::move(r);
+            ready.notify_one();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < nthreads; ++t)
+        threads.emplace_back(worker);
+
+    auto stop = [&] {
+        {
+            std::scoped_lock lck {m};
+            next = chunks.size();
+        }
+        room.notify_all();
+        for(auto& t : threads) t.join();
+    };
+
+    try {
+        std::size_t line = 0;       // lines before the current chunk
+        for(std::size_t i = 0; i < chunks.size(); ++i) {
+            Result r;
+            {
+                std::unique_lock lck {m};
+                ready.wait(lck, [&]{ return results[i].done; });
+                r = std::move(results[i]);
+                emitted = i + 1;
+            }
+            room.notify_all();
+            for(auto& z : r.matches) {
+                z.line += line;
+                f(static_cast<const Zip_match&>(z));
+            }
+            line += r.newlines;
+        }
+    }
+    catch(...) {
+        stop();
+        throw;
+    }
+    stop();
+}
+
+} // namespace Address
+} // namespace my
+
+#endif
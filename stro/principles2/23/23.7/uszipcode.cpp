@@ -1,25 +1,49 @@
+#include "zip_scanner.h"
+#include "parallel_scan.h"
+#include "../../mapped_file.h"
 #include <iostream>
 #include <string>
-#include <fstream>
-#include <regex>
+#include <cstdlib>
 using namespace std;
 
-int main()
+// usage: uszipcode [-c] [-j threads] [file]
+// prints every zip code of file (uszipcode.txt by default) as
+// "lineno : match", or "lineno:column : match" with -c.
+// -j scans on that many threads (0 for one per core); the output is the same.
+int main(int argc, char* argv[])
+try
 {
-    ifstream in {"uszipcode.txt"};
-    if(!in) cerr << "failed to open" << endl;
-
-    regex pat {R"(\w{2}\s*\d{5}(-\d{4})?)"};
-    // regex pat {"\\w{2}\\s*\\d{5}(-\\d{4})?"};
-
-    int lineno = 0;
-    for(string line; getline(in, line); ) {
-        ++lineno;
-        smatch matches;
-        if(regex_search(line, matches, pat)) {
-            cout << lineno << " : " << matches[0] << endl;
-            if(1<matches.size() && matches[1].matched)
-                cout << "\t: " << matches[1] << endl;
+    bool columns = false;
+    bool parallel = false;
+    unsigned nthreads = 0;
+    string path = "uszipcode.txt";
+    for(int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if(arg == "-c") columns = true;
+        else if(arg == "-j" && i+1 < argc) {
+            parallel = true;
+            nthreads = atoi(argv[++i]);
         }
+        else path = arg;
     }
-}
\ No newline at end of file
+
+    my::Mapped_file in {path};
+
+    // the pattern the scanner is compiled from:
+    // regex pat {R"(\w{2}\s*\d{5}(-\d{4})?)"};
+    auto print = [&](const my::Address::Zip_match& m) {
+        cout << m.line;
+        if(columns) cout << ':' << m.column;
+        cout << " : " << m.text << '\n';
+        if(!m.plus4.empty())
+            cout << "\t: " << m.plus4 << '\n';
+    };
+    if(parallel)
+        my::Address::scan_zipcodes_parallel(in.view(), print, nthreads);
+    else
+        my::Address::scan_zipcodes(in.view(), print);
+}
+catch(exception& e) {
+    cerr << "failed to open " << e.what() << endl;
+    return 1;
+}
@@ -0,0 +1,136 @@
+#ifndef MY_ADDRESS_ZIP_SCANNER_H
+#define MY_ADDRESS_ZIP_SCANNER_H
+
+#include <string_view>
+#include <array>
+#include <cstdint>
+
+namespace my {
+namespace Address {
+
+/**
+ * A match of R"(\w{2}\s*\d{5}(-\d{4})?)" within one line.
+ */
+struct Zip_match {
+    std::size_t line;           // 1-based
+    std::size_t column;         // 1-based, in bytes
+    std::string_view text;      // the whole match
+    std::string_view plus4;     // the "-dddd" part, if any
+};
+
+namespace Zip_dfa {
+
+// character classes of the pattern; '\n' ends a line, as getline() does
+enum Class : std::uint8_t { other, digit, word, space, newline, n_classes };
+
+constexpr std::array<std::uint8_t, 256> make_classes()
+{
+    std::array<std::uint8_t, 256> c {};
+    for(int i = '0'; i <= '9'; ++i) c[i] = digit;
+    for(int i = 'a'; i <= 'z'; ++i) c[i] = word;
+    for(int i = 'A'; i <= 'Z'; ++i) c[i] = word;
+    c['_'] = word;
+    for(int i = '\t'; i <= '\r'; ++i) c[i] = space;
+    c[' '] = space;
+    c['\n'] = newline;
+    return c;
+}
+
+constexpr auto classes = make_classes();
+
+/*
+ * The NFA of \w\w\s*\d{5}, one state per bit:
+ *   bit 0  one \w read
+ *   bit 1  \w\w read, and possibly some \s
+ *   bit 2..6  1..5 digits read; bit 6 accepts
+ * A DFA state is the set of NFA states live at once, one per candidate
+ * start, with the initial state implicitly always live, as in a search.
+ */
+constexpr std::uint8_t accept = 1 << 6;
+
+constexpr std::uint8_t step(std::uint8_t s, int cls)
+{
+    if(cls == newline) return 0;
+    std::uint8_t t = 0;
+    const bool w = cls == word || cls == digit;
+    if(w) t |= 1;                       // a new candidate starts
+    if(w && (s & 1)) t |= 2;
+    if(cls == space && (s & 2)) t |= 2;
+    if(cls == digit) {
+        if(s & 2) t |= 4;
+        t |= (s & (4 | 8 | 16 | 32)) << 1;
+    }
+    return t;
+}
+
+constexpr std::array<std::array<std::uint8_t, n_classes>, 128> make_table()
+{
+    std::array<std::array<std::uint8_t, n_classes>, 128> t {};
+    for(int s = 0; s < 128; ++s)
+        for(int c = 0; c < n_classes; ++c)
+            t[s][c] = step(s, c);
+    return t;
+}
+
+constexpr auto table = make_table();
+
+} // namespace Zip_dfa
+
+/**
+ * Calls f(const Zip_match&) for every match of R"(\w{2}\s*\d{5}(-\d{4})?)"
+ * in text, in order: what std::regex_search would find on each line,
+ * searched again after the end of every match.
+ * Lines are numbered from first_line; returns the number of '\n's in text.
+ */
+template<typename F>
+std::size_t scan_zipcodes(std::string_view text, F f, std::size_t first_line = 1)
+{
+    using namespace Zip_dfa;
+    const auto cls = [](char c){ return classes[static_cast<unsigned char>(c)]; };
+
+    const char* const first = text.data();
+    const char* const last = first + text.size();
+    const char* line_start = first;
+    std::size_t line = first_line;
+    std::uint8_t s = 0;
+
+    for(const char* p = first; p != last; ++p) {
+        const std::uint8_t c = cls(*p);
+        if(c == newline) {
+            ++line;
+            line_start = p + 1;
+            s = 0;
+            continue;
+        }
+        s = table[s][c];
+        if(!(s & accept)) continue;
+
+        // the leftmost start is the only candidate that accepts here:
+        // back over the digits, the spaces and the two \w
+        const char* end = p + 1;
+        const char* q = end - 5;
+        while(cls(q[-1]) == space) --q;
+        const char* start = q - 2;
+
+        std::string_view plus4;
+        if(last - end >= 5 && *end == '-'
+            && cls(end[1]) == digit && cls(end[2]) == digit
+            && cls(end[3]) == digit && cls(end[4]) == digit) {
+            plus4 = std::string_view(end, 5);
+            end += 5;
+        }
+
+        f(Zip_match{line, std::size_t(start - line_start) + 1,
+                    std::string_view(start, end - start), plus4});
+
+        // search again after the match
+        p = end - 1;
+        s = 0;
+    }
+    return line - first_line;
+}
+
+} // namespace Address
+} // namespace my
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef MY_INTERNER_H
+#define MY_INTERNER_H
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace my {
+
+/**
+ * Bump allocator for bytes: allocations are carved from large blocks
+ * and are never freed one by one, only all together.
+ */
+class Arena {
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::size_t block_size;
+    char* cur = nullptr;
+    std::size_t left = 0;
+    std::size_t total = 0;
+public:
+    explicit Arena(std::size_t block = 1 << 20) : block_size{block} {}
+
+    Arena(Arena&& a)
+        : blocks{std::move(a.blocks)}
+        , block_size{a.block_size}
+        , cur{std::exchange(a.cur, nullptr)}
+        , left{std::exchange(a.left, 0)}
+        , total{std::exchange(a.total, 0)}
+    {}
+
+    char* allocate(std::size_t n)
+    {
+        if(n > left) {
+            std::size_t b = std::max(n, block_size);
+            blocks.emplace_back(new char[b]);
+            cur = blocks.back().get();
+            left = b;
+            total += b;
+        }
+        char* p = cur;
+        cur += n;
+        left -= n;
+        return p;
+    }
+
+    std::string_view copy(std::string_view s)
+    {
+        char* p = allocate(s.size());
+        std::memcpy(p, s.data(), s.size());
+        return {p, s.size()};
+    }
+
+    // bytes held, used or not
+    std::size_t bytes() const { return total; }
+
+    void clear()
+    {
+        blocks.clear();
+        cur = nullptr;
+        left = total = 0;
+    }
+};
+
+/**
+ * Maps each distinct string to a dense 32-bit id, 0, 1, 2, ...
+ * in order of first appearance. Each string is copied once into an Arena,
+ * so the string_views it hands out stay valid until clear().
+ */
+class Interner {
+public:
+    typedef std::uint32_t Id;
+    static constexpr Id npos = UINT32_MAX;
+private:
+    Arena arena;
+    std::vector<std::string_view> strings;     // by id
+    std::vector<std::uint32_t> hashes;          // by id, to skip compares and rehash
+    std::vector<Id> slots;                      // open addressing; npos is empty
+
+    static std::uint32_t hash(std::string_view s)
+    {
+        return static_cast<std::uint32_t>(std::hash<std::string_view>{}(s));
+    }
+
+    std::size_t slot_of(std::string_view s, std::uint32_t h) const
+    {
+        const std::size_t mask = slots.size() - 1;
+        std::size_t i = h & mask;
+        while(slots[i] != npos && (hashes[slots[i]] != h || strings[slots[i]] != s))
+            i = (i + 1) & mask;
+        return i;
+    }
+
+    void grow()
+    {
+        slots.assign(slots.size() * 2, npos);
+        const std::size_t mask = slots.size() - 1;
+        for(Id id = 0; id < strings.size(); ++id) {
+            std::size_t i = hashes[id] & mask;
+            while(slots[i] != npos) i = (i + 1) & mask;
+            slots[i] = id;
+        }
+    }
+public:
+    explicit Interner(std::size_t arena_block = 1 << 20)
+        : arena{arena_block}
+        , slots(1024, npos)
+    {}
+
+    Id intern(std::string_view s)
+    {
+        const std::uint32_t h = hash(s);
+        std::size_t i = slot_of(s, h);
+        if(slots[i] != npos) return slots[i];
+
+        const Id id = static_cast<Id>(strings.size());
+        strings.push_back(arena.copy(s));
+        hashes.push_back(h);
+        slots[i] = id;
+        if(strings.size() * 2 > slots.size()) grow();
+        return id;
+    }
+
+    // the id of s, or npos if s was never interned
+    Id find(std::string_view s) const { return slots[slot_of(s, hash(s))]; }
+
+    std::string_view view(Id id) const { return strings[id]; }
+    std::size_t size() const { return strings.size(); }
+
+    // bytes held by the arena and the tables
+    std::size_t bytes() const
+    {
+        return arena.bytes()
+            + strings.capacity() * sizeof(std::string_view)
+            + hashes.capacity() * sizeof(std::uint32_t)
+            + slots.capacity() * sizeof(Id);
+    }
+
+    // frees every string at once; all ids and views become invalid
+    void clear()
+    {
+        arena.clear();
+        strings.clear();
+        hashes.clear();
+        slots.assign(1024, npos);
+    }
+};
+
+} // namespace my
+
+#endif
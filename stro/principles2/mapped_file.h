@@ -0,0 +1,133 @@
+#ifndef MY_MAPPED_FILE_H
+#define MY_MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <utility>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace my {
+
+/**
+ * Read-only view of a whole file.
+ * A regular file is mmap(2)ed; anything else (a pipe, a tty)
+ * is read(2) into an owned buffer, so stdin works as well.
+ */
+class Mapped_file {
+    char* p = nullptr;
+    std::size_t sz = 0;
+    bool mapped = false;
+
+    static std::runtime_error failure(const std::string& what)
+    {
+        return std::runtime_error{what + ": " + std::strerror(errno)};
+    }
+
+    void load(int fd, const std::string& name)
+    {
+        struct stat st;
+        if(::fstat(fd, &st) < 0) throw failure(name);
+
+        if(S_ISREG(st.st_mode)) {
+            sz = st.st_size;
+            if(sz == 0) return;
+            void* m = ::mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(m == MAP_FAILED) throw failure(name);
+            ::madvise(m, sz, MADV_SEQUENTIAL);
+            p = static_cast<char*>(m);
+            mapped = true;
+            return;
+        }
+
+        std::size_t cap = 1 << 20;
+        p = new char[cap];
+        for(;;) {
+            if(sz == cap) {
+                char* q = new char[cap * 2];
+                std::memcpy(q, p, sz);
+                delete[] p;
+                p = q;
+                cap *= 2;
+            }
+            ssize_t n = ::read(fd, p + sz, cap - sz);
+            if(n == 0) break;
+            if(n < 0) {
+                if(errno == EINTR) continue;
+                release();
+                throw failure(name);
+            }
+            sz += n;
+        }
+    }
+
+    void release()
+    {
+        if(mapped) ::munmap(p, sz);
+        else delete[] p;
+        p = nullptr;
+        sz = 0;
+        mapped = false;
+    }
+
+public:
+    explicit Mapped_file(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw failure(path);
+        try {
+            load(fd, path);
+        }
+        catch(...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+    }
+
+    // the descriptor stays open; e.g. Mapped_file{0} for stdin
+    explicit Mapped_file(int fd) { load(fd, "fd " + std::to_string(fd)); }
+
+    Mapped_file(const Mapped_file&) = delete;
+    Mapped_file& operator=(const Mapped_file&) = delete;
+
+    Mapped_file(Mapped_file&& f)
+        : p{std::exchange(f.p, nullptr)}
+        , sz{std::exchange(f.sz, 0)}
+        , mapped{std::exchange(f.mapped, false)}
+    {}
+
+    Mapped_file& operator=(Mapped_file&& f)
+    {
+        if(this != &f) {
+            release();
+            p = std::exchange(f.p, nullptr);
+            sz = std::exchange(f.sz, 0);
+            mapped = std::exchange(f.mapped, false);
+        }
+        return *this;
+    }
+
+    ~Mapped_file() { release(); }
+
+    // true if fd is a regular file, which is mapped rather than read
+    static bool can_map(int fd)
+    {
+        struct stat st;
+        return ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    }
+
+    const char* data() const { return p; }
+    std::size_t size() const { return sz; }
+    std::string_view view() const { return {p, sz}; }
+};
+
+} // namespace my
+
+#endif
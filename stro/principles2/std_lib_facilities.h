@@ -19,6 +19,7 @@
 	Revised November 25 2013: remove support for pre-C++11 compilers, use C++11: <chrono>
 	Revised November 28 2013: add a few container algorithms
 	Revised June 8 2014: added #ifndef to workaround Microsoft C++11 weakness
+	Revised October 18 2026: PPP_RANGE_CHECK; checked iterators in debug builds, no checks with NDEBUG
 */
 
 #ifndef H112
@@ -41,6 +42,7 @@
 #include <regex>
 #include<random>
 #include<stdexcept>
+#include<cassert>
 
 //------------------------------------------------------------------------------
 
@@ -66,55 +68,110 @@ struct Range_error : out_of_range {	// enhanced vector range error reporting
 };
 
 
-// trivially range-checked vector (no iterator checking):
-template< class T> struct Vector : public std::vector<T> {
-	using size_type = typename std::vector<T>::size_type;
+// How much Vector and String check, chosen by the build:
+//   PPP_RANGE_CHECK 1, the default without NDEBUG: operator[] throws Range_error,
+//     and with libstdc++ Vector's iterators are checked as well
+//   PPP_RANGE_CHECK 0, the default with NDEBUG: operator[] only assert()s, which
+//     NDEBUG strips, so that it costs what std::vector's does
+#ifndef PPP_RANGE_CHECK
+#ifdef NDEBUG
+#define PPP_RANGE_CHECK 0
+#else
+#define PPP_RANGE_CHECK 1
+#endif
+#endif
+
+// Vector and String live in an inline namespace named after the mode. The two
+// modes' Vectors differ in layout (__gnu_debug::vector is bigger), so every
+// translation unit of a program must be built in the same mode; the names
+// differ too, so that a program mixing the modes fails to link rather than
+// passing one mode's Vector to code compiled for the other.
+#if PPP_RANGE_CHECK
+#define PPP_CHECK_MODE range_checked
+#else
+#define PPP_CHECK_MODE range_unchecked
+#endif
+
+#if PPP_RANGE_CHECK && defined(__GLIBCXX__) && !defined(_GLIBCXX_DEBUG)
+#include <debug/vector>
+#endif
+
+inline namespace PPP_CHECK_MODE {
+
+#if PPP_RANGE_CHECK && defined(__GLIBCXX__) && !defined(_GLIBCXX_DEBUG)
+// a vector that checks its iterators too
+template<class T> using Vector_base = __gnu_debug::vector<T>;
+#else
+template<class T> using Vector_base = std::vector<T>;
+#endif
+
+// range-checked vector:
+template< class T> struct Vector : public Vector_base<T> {
+	using size_type = typename Vector_base<T>::size_type;
 
 #ifdef _MSC_VER
 	// microsoft doesn't yet support C++11 inheriting constructors
 	Vector() { }
-	explicit Vector(size_type n) :std::vector<T>(n) {}
-	Vector(size_type n, const T& v) :std::vector<T>(n,v) {}
+	explicit Vector(size_type n) :Vector_base<T>(n) {}
+	Vector(size_type n, const T& v) :Vector_base<T>(n,v) {}
 	template <class I>
-	Vector(I first, I last) : std::vector<T>(first, last) {}
-	Vector(initializer_list<T> list) : std::vector<T>(list) {}
+	Vector(I first, I last) : Vector_base<T>(first, last) {}
+	Vector(initializer_list<T> list) : Vector_base<T>(list) {}
 #else
-	using std::vector<T>::vector;	// inheriting constructor
+	using Vector_base<T>::Vector_base;	// inheriting constructor
 #endif
 
 	T& operator[](unsigned int i) // rather than return at(i);
 	{
+#if PPP_RANGE_CHECK
 		if (i<0||this->size()<=i) throw Range_error(i);
-		return std::vector<T>::operator[](i);
+#else
+		assert(i<this->size());
+#endif
+		return Vector_base<T>::operator[](i);
 	}
 	const T& operator[](unsigned int i) const
 	{
+#if PPP_RANGE_CHECK
 		if (i<0||this->size()<=i) throw Range_error(i);
-		return std::vector<T>::operator[](i);
+#else
+		assert(i<this->size());
+#endif
+		return Vector_base<T>::operator[](i);
 	}
 };
 
 // disgusting macro hack to get a range checked vector:
 #define vector Vector
 
-// trivially range-checked string (no iterator checking):
+// range-checked string (no iterator checking):
 struct String : std::string {
 	using size_type = std::string::size_type;
 //	using string::string;
 
 	char& operator[](unsigned int i) // rather than return at(i);
 	{
+#if PPP_RANGE_CHECK
 		if (i<0||size()<=i) throw Range_error(i);
+#else
+		assert(i<size());
+#endif
 		return std::string::operator[](i);
 	}
 
 	const char& operator[](unsigned int i) const
 	{
+#if PPP_RANGE_CHECK
 		if (i<0||size()<=i) throw Range_error(i);
+#else
+		assert(i<size());
+#endif
 		return std::string::operator[](i);
 	}
 };
 
+}	// of inline namespace PPP_CHECK_MODE
+
 
 namespace std {
 
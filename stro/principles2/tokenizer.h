@@ -0,0 +1,200 @@
+#ifndef MY_TOKENIZER_H
+#define MY_TOKENIZER_H
+
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MY_TOKENIZER_AVX2 1
+#endif
+
+namespace my {
+
+// the characters operator>>(istream&, string&) skips in the "C" locale
+inline bool is_space(char c)
+{
+    return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+// bit j of the result is is_space(p[j]), for 64 bytes at p
+typedef std::uint64_t (*Space_mask)(const char* p);
+
+inline std::uint64_t space_mask_scalar(const char* p)
+{
+    std::uint64_t m = 0;
+    for(int j = 0; j < 64; ++j)
+        m |= std::uint64_t(is_space(p[j])) << j;
+    return m;
+}
+
+#ifdef MY_TOKENIZER_AVX2
+__attribute__((target("avx2")))
+inline std::uint32_t space_mask32_avx2(const char* p)
+{
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    // c-'\t' <= '\r'-'\t' unsigned, i.e. '\t' <= c <= '\r'
+    __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8('\r' - '\t')), d);
+    __m256i sp = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), ctl);
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(sp));
+}
+
+__attribute__((target("avx2")))
+inline std::uint64_t space_mask_avx2(const char* p)
+{
+    return space_mask32_avx2(p) | std::uint64_t(space_mask32_avx2(p + 32)) << 32;
+}
+#endif
+
+// the fastest Space_mask this CPU runs
+inline Space_mask best_space_mask()
+{
+#ifdef MY_TOKENIZER_AVX2
+    static const Space_mask f = __builtin_cpu_supports("avx2") ? space_mask_avx2 : space_mask_scalar;
+    return f;
+#else
+    return space_mask_scalar;
+#endif
+}
+
+/**
+ * Yields the whitespace-delimited words of a buffer as string_views,
+ * i.e. the same words that `for(string s; cin >> s;)` would read.
+ * The buffer is classified 64 bytes at a time into a whitespace bitmask;
+ * words begin and end where the mask changes.
+ */
+class Tokenizer {
+    const char* buf;
+    std::size_t sz;
+    Space_mask space_mask;
+    std::size_t base = 0;       // offset of the block the edges belong to
+    std::size_t next_base = 0;
+    std::uint64_t edges = 0;    // unvisited word starts and ends in the block
+    std::uint64_t carry = 1;    // was the byte before the block a space?
+    std::size_t word = 0;       // start of the current word
+    bool in_word = false;
+
+    bool load_block()
+    {
+        if(next_base >= sz) return false;
+        base = next_base;
+        next_base += 64;
+        std::uint64_t m;
+        if(sz - base >= 64)
+            m = space_mask(buf + base);
+        else {
+            char tail[64];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, buf + base, sz - base);
+            m = space_mask(tail);
+        }
+        edges = m ^ (m << 1 | carry);
+        carry = m >> 63;
+        return true;
+    }
+public:
+    explicit Tokenizer(std::string_view s, Space_mask f = best_space_mask())
+        : buf{s.data()}, sz{s.size()}, space_mask{f}
+    {}
+
+    bool next(std::string_view& w)
+    {
+        for(;;) {
+            while(edges == 0) {
+                if(!load_block()) {
+                    if(!in_word) return false;
+                    in_word = false;
+                    w = std::string_view(buf + word, sz - word);
+                    return true;
+                }
+            }
+            std::size_t at = base + __builtin_ctzll(edges);
+            edges &= edges - 1;
+            if(!in_word) {
+                word = at;
+                in_word = true;
+            }
+            else {
+                in_word = false;
+                w = std::string_view(buf + word, at - word);
+                return true;
+            }
+        }
+    }
+};
+
+/**
+ * Calls f(std::string_view) for every whitespace-delimited word in buf.
+ */
+template<typename F>
+void for_each_word(std::string_view buf, F f)
+{
+    Tokenizer t {buf};
+    for(std::string_view w; t.next(w); )
+        f(w);
+}
+
+/**
+ * Formatted input from a buffer in the manner of an istream:
+ * each operator>> skips whitespace and reads what it can,
+ * and after a failure the reader stays failed.
+ */
+class Token_reader {
+    Tokenizer t;
+    std::string_view cur;       // the unread part of the current word
+    bool ok = true;
+
+    bool fill()
+    {
+        while(ok && cur.empty())
+            if(!t.next(cur)) ok = false;
+        return ok;
+    }
+
+    template<typename T>
+    Token_reader& number(T& x)
+    {
+        if(!fill()) return *this;
+        const char* first = cur.data();
+        if(*first == '+' && cur.size() > 1 && *(first + 1) != '-') ++first;
+        auto [p, ec] = std::from_chars(first, cur.data() + cur.size(), x);
+        if(ec != std::errc{}) ok = false;
+        else cur.remove_prefix(p - cur.data());
+        return *this;
+    }
+public:
+    explicit Token_reader(std::string_view buf) : t{buf} {}
+
+    Token_reader& operator>>(char& c)
+    {
+        if(fill()) {
+            c = cur.front();
+            cur.remove_prefix(1);
+        }
+        return *this;
+    }
+
+    // the rest of the current word, like operator>>(istream&, string&)
+    Token_reader& operator>>(std::string_view& s)
+    {
+        if(fill()) {
+            s = cur;
+            cur = {};
+        }
+        return *this;
+    }
+
+    Token_reader& operator>>(int& i) { return number(i); }
+    Token_reader& operator>>(long& i) { return number(i); }
+    Token_reader& operator>>(double& d) { return number(d); }
+
+    void fail() { ok = false; }
+    explicit operator bool() const { return ok; }
+};
+
+} // namespace my
+
+#endif
@@ -1,9 +1,45 @@
 #include "Container.hpp"
 
+// elements copied at a time when they are not one array
+constexpr size_t chunk_size = 512;
+
+void Container::visit_chunks(const std::function<void(std::span<const double>)>& f) {
+    if (auto s = contiguous_span()) {
+        f(*s);
+        return;
+    }
+    double buf[chunk_size];
+    const size_t sz = size();
+    for (size_t i = 0; i < sz; i += chunk_size) {
+        const size_t n = std::min(chunk_size, sz - i);
+        for (size_t j = 0; j < n; j++)
+            buf[j] = (*this)[i + j];
+        f({buf, n});
+    }
+}
+
+size_t Container::copy_to(std::span<double> out) {
+    // stops once out is full, however many elements are left
+    const size_t n = std::min(out.size(), size());
+    if (auto s = contiguous_span()) {
+        std::copy_n(s->begin(), n, out.begin());
+        return n;
+    }
+    for (size_t i = 0; i < n; i++)
+        out[i] = (*this)[i];
+    return n;
+}
+
 double accum(Container& c) {
-    const size_t sz = c.size();
+    if (auto s = c.contiguous_span())
+        return my::sum(*s);
     double a = 0;
-    for (size_t i = 0; i < sz; i++)
-        a += c[i];
+    c.visit_chunks([&](std::span<const double> chunk) { a += my::sum(chunk); });
     return a;
-}
\ No newline at end of file
+}
+
+double parallel_accum(Container& c, unsigned nthreads) {
+    if (auto s = c.contiguous_span())
+        return my::parallel_sum(*s, nthreads);
+    return accum(c);
+}
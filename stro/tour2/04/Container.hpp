@@ -1,10 +1,47 @@
+#include "../reduce.hpp"
 #include <algorithm>
+#include <functional>
+#include <optional>
+#include <span>
 
 class Container {
 public:
     virtual double& operator[](size_t) = 0;
     virtual size_t size() const = 0;
     virtual ~Container() {}
+
+    // Batch access, one virtual call for many elements:
+    // f(chunk) for consecutive chunks of the elements, in order
+    virtual void visit_chunks(const std::function<void(std::span<const double>)>& f);
+    // copies the first elements to out, as many as fit; returns how many
+    virtual size_t copy_to(std::span<double> out);
+
+    // the elements, if they are one array: one virtual call, and then
+    // loops over them need not call through the vtbl at all. Computed on
+    // each call, so that it is never left pointing at a copy's source
+    virtual std::optional<std::span<const double>> contiguous_span() const { return std::nullopt; }
+};
+
+double accum(Container&);
+// accum() on nthreads threads (0: one per core) if the elements are one array;
+// the result does not depend on nthreads
+double parallel_accum(Container&, unsigned nthreads = 0);
+
+// The same interface resolved at compile time, for callers that know the
+// concrete type: D has operator[] and size(), and maybe data()
+template<typename D>
+class Static_container {
+public:
+    D& derived() { return static_cast<D&>(*this); }
 };
 
-double accum(Container&);
\ No newline at end of file
+template<typename D>
+double accum(Static_container<D>& c) {
+    D& d = c.derived();
+    if constexpr (requires { d.data(); })
+        return my::sum({d.data(), d.size()});
+    double a = 0;
+    for (size_t i = 0; i < d.size(); i++)
+        a += d[i];
+    return a;
+}
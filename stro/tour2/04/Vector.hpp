@@ -11,7 +11,13 @@ public:
     {
         std::copy(list.begin(), list.end(), elem);
     }
+    explicit Vector(size_t s)
+      : elem { new double[s] },
+        sz { s }
+    {}
 
     double& operator[](int i) { return elem[i]; }
     size_t size() const { return sz; }
+    double* data() { return elem; }
+    const double* data() const { return elem; }
 };
@@ -1,20 +1,121 @@
 #include "Container.hpp"
 #include "Vector.hpp"
 #include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <stdexcept>
+#include <thread>
 
 class Vector_container :public Container {
     Vector v;
 public:
     Vector_container(std::initializer_list<double> list)
       : v { Vector(list) } {}
+    explicit Vector_container(size_t s)
+      : v { Vector(s) } {}
     ~Vector_container() {}
 
     double& operator[](size_t i) override { return v[i]; }
     size_t size() const override { return v.size(); }
+    std::optional<std::span<const double>> contiguous_span() const override { return std::span{v.data(), v.size()}; }
+};
+
+// not an array: accum() goes through visit_chunks()
+class List_container :public Container {
+    std::list<double> ld;
+public:
+    List_container(std::initializer_list<double> list)
+      : ld { list } {}
+
+    double& operator[](size_t i) override {
+        for (auto& x : ld) {
+            if (i == 0) return x;
+            --i;
+        }
+        throw std::out_of_range{"List_container"};
+    }
+    size_t size() const override { return ld.size(); }
+
+    void visit_chunks(const std::function<void(std::span<const double>)>& f) override {
+        double buf[512];
+        size_t n = 0;
+        for (double x : ld) {
+            buf[n++] = x;
+            if (n == std::size(buf)) {
+                f({buf, n});
+                n = 0;
+            }
+        }
+        if (n) f({buf, n});
+    }
+};
+
+// Vector_container without virtual functions
+class Static_vector_container :public Static_container<Static_vector_container> {
+    Vector v;
+public:
+    explicit Static_vector_container(size_t s)
+      : v { Vector(s) } {}
 
+    double& operator[](size_t i) { return v[i]; }
+    size_t size() const { return v.size(); }
+    double* data() { return v.data(); }
 };
 
-int main() {
+// what accum(Container&) did: a virtual call per element
+__attribute__((noinline))
+double accum_each(Container& c) {
+    const size_t sz = c.size();
+    double a = 0;
+    for (size_t i = 0; i < sz; i++)
+        a += c[i];
+    return a;
+}
+
+template<typename F>
+void time_it(const char* name, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    double a = f();
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << name << std::chrono::duration<double>(t2 - t1).count() << " s, " << a << "\n";
+}
+
+// usage: a.out [n]
+// with n, times accum over n elements each way
+int main(int argc, char* argv[]) {
     Vector_container v {1, 2, 3, 4};
     assert(accum(v) == 10);
-}
\ No newline at end of file
+    const Container& cv = v;
+    assert(cv.contiguous_span() && cv.contiguous_span()->size() == 4);
+
+    List_container l {1, 2, 3, 4};
+    assert(accum(l) == 10 && accum_each(l) == 10);
+    assert(!l.contiguous_span());
+    double out[3];
+    assert(l.copy_to(out) == 3 && out[2] == 3);
+    assert(v.copy_to(out) == 3 && out[0] == 1);
+    assert(parallel_accum(v, 2) == 10 && parallel_accum(l) == 10);
+
+    if (argc < 2)
+        return 0;
+    const size_t n = std::atol(argv[1]);
+    Vector_container vc(n);
+    Static_vector_container sc(n);
+    for (size_t i = 0; i < n; i++)
+        vc[i] = sc[i] = i % 100;
+
+    time_it("virtual operator[] per element: ", [&]{ return accum_each(vc); });
+    time_it("visit_chunks():                 ", [&]{
+        double a = 0;
+        vc.visit_chunks([&](std::span<const double> s) { a += my::sum(s); });
+        return a;
+    });
+    time_it("contiguous_span():              ", [&]{ return accum(vc); });
+    time_it("Static_container:               ", [&]{ return accum(sc); });
+    for (unsigned t : {1u, 2u, 4u, 0u}) {
+        std::cout << (t ? t : std::thread::hardware_concurrency()) << " threads: ";
+        time_it("parallel_accum():   ", [&]{ return parallel_accum(vc, t); });
+    }
+}
@@ -1,103 +1,331 @@
 #include "Vector.hpp"
+#include "../reduce.hpp"
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace my
 {
 
-template<typename T>
-Vector<T>::Vector(std::initializer_list<T> list)
-    : elem{ new T[list.size()] }
-    , sz{ list.size() }
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>::Vector(std::initializer_list<T> list, const A& a)
+    : Vector{ a }
 {
-    std::copy(list.begin(), list.end(), elem);
+    reserve(list.size());
+    for (const auto& x : list)
+    {
+        traits::construct(alloc, elem + sz, x);
+        ++sz;
+    }
 }
 
-template<typename T>
-Vector<T>::Vector(size_t len)
-    : elem{ new T[len] }
-    , sz{ len }
-{}
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>::Vector(size_t len, const A& a)
+    : Vector{ a }
+{
+    reserve(len);
+    for (; sz < len; ++sz)
+    {
+        traits::construct(alloc, elem + sz);
+    }
+}
 
-template<typename T>
-Vector<T>::Vector()
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>::Vector(const A& a)
     : elem{ nullptr }
-    , sz{ 0 }
+    , alloc{ a }
+{
+    elem = buf.data();
+}
+
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>::Vector()
+    : Vector{ A{} }
 {}
 
-template<typename T>
-Vector<T>::Vector(const Vector<T>& v)
-    : elem{ new T[v.sz] }
-    , sz{ v.sz }
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>::Vector(const Vector& v)
+    : Vector{ traits::select_on_container_copy_construction(v.alloc) }
 {
-    std::copy(v.begin(), v.end(), elem);
+    reserve(v.sz);
+    for (; sz < v.sz; ++sz)
+    {
+        traits::construct(alloc, elem + sz, v.elem[sz]);
+    }
 }
 
-template<typename T>
-Vector<T>& Vector<T>::operator=(const Vector<T>& v)
+// reuses the memory it has when that is large enough
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>& Vector<T, N, A, C>::operator=(const Vector& v)
 {
-    T* p = new T[ v.sz ];
-    std::copy(v.begin(), v.end(), p);
-    delete[] elem;
-    elem = p;
-    sz = v.sz;
+    if (this == &v)
+    {
+        return *this;
+    }
+    if constexpr (traits::propagate_on_container_copy_assignment::value)
+    {
+        if (alloc != v.alloc)
+        {
+            release();
+        }
+        alloc = v.alloc;
+    }
+    if (v.sz > cap)
+    {
+        clear();
+        reserve(v.sz);
+    }
+    std::copy(v.elem, v.elem + std::min(sz, v.sz), elem);
+    for (; sz < v.sz; ++sz)
+    {
+        traits::construct(alloc, elem + sz, v.elem[sz]);
+    }
+    while (sz > v.sz)
+    {
+        pop_back();
+    }
     return *this;
 }
 
-template<typename T>
-Vector<T>::Vector(Vector<T>&& v)
-    : elem{ v.elem }
-    , sz{ v.sz }
+// takes v's memory, or moves the elements out of its inline buffer
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>::Vector(Vector&& v) noexcept(std::is_nothrow_move_constructible_v<T>)
+    : Vector{ std::move(v.alloc) }
 {
-    v.elem = nullptr;
-    v.sz = 0;
+    if (v.on_heap())
+    {
+        elem = v.elem;
+        sz = v.sz;
+        cap = v.cap;
+        v.elem = v.buf.data();
+        v.sz = 0;
+        v.cap = N;
+        return;
+    }
+    for (; sz < v.sz; ++sz)
+    {
+        traits::construct(alloc, elem + sz, std::move(v.elem[sz]));
+    }
+    v.clear();
 }
 
-template<typename T>
-Vector<T>& Vector<T>::operator=(Vector<T>&& v)
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>& Vector<T, N, A, C>::operator=(Vector&& v)
 {
-    delete[] elem;
-    elem = v.elem;
-    sz = v.sz;
-    v.elem = nullptr;
-    v.sz = 0;
+    if (this == &v)
+    {
+        return *this;
+    }
+    release();
+    constexpr bool propagate = traits::propagate_on_container_move_assignment::value;
+    if constexpr (propagate)
+    {
+        alloc = std::move(v.alloc);
+    }
+    if (v.on_heap() && (propagate || alloc == v.alloc))
+    {
+        elem = v.elem;
+        sz = v.sz;
+        cap = v.cap;
+        v.elem = v.buf.data();
+        v.sz = 0;
+        v.cap = N;
+        return *this;
+    }
+    reserve(v.sz);
+    for (; sz < v.sz; ++sz)
+    {
+        traits::construct(alloc, elem + sz, std::move(v.elem[sz]));
+    }
+    v.clear();
     return *this;
 }
 
-template<typename T>
-Vector<T>::~Vector()
+template<typename T, size_t N, typename A, typename C>
+Vector<T, N, A, C>::~Vector()
 {
-    delete[] elem;
+    release();
 }
 
-template<typename T>
-T& Vector<T>::operator[](size_t i) const
+template<typename T, size_t N, typename A, typename C>
+void Vector<T, N, A, C>::release()
+{
+    clear();
+    if (on_heap())
+    {
+        traits::deallocate(alloc, elem, cap);
+    }
+    elem = buf.data();
+    cap = N;
+}
+
+// moves the elements to p, which holds n, and frees the old memory;
+// if a move throws, the elements stay where they were
+template<typename T, size_t N, typename A, typename C>
+void Vector<T, N, A, C>::move_to(T* p, size_t n)
+{
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        if (sz)
+        {
+            std::memcpy(static_cast<void*>(p), elem, sz * sizeof(T));
+        }
+    }
+    else
+    {
+        size_t i = 0;
+        try
+        {
+            for (; i < sz; ++i)
+            {
+                traits::construct(alloc, p + i, std::move_if_noexcept(elem[i]));
+            }
+        }
+        catch (...)
+        {
+            while (i)
+            {
+                traits::destroy(alloc, p + --i);
+            }
+            throw;
+        }
+        for (i = 0; i < sz; ++i)
+        {
+            traits::destroy(alloc, elem + i);
+        }
+    }
+    if (on_heap())
+    {
+        traits::deallocate(alloc, elem, cap);
+    }
+    elem = p;
+    cap = n;
+}
+
+template<typename T, size_t N, typename A, typename C>
+void Vector<T, N, A, C>::grow(size_t n)
 {
-    assert(elem != nullptr);
-    if ( i >= sz )
+    T* p = traits::allocate(alloc, n);
+    try
     {
-        throw std::out_of_range{ "Vector::operator[]" };
+        move_to(p, n);
     }
+    catch (...)
+    {
+        traits::deallocate(alloc, p, n);
+        throw;
+    }
+}
+
+template<typename T, size_t N, typename A, typename C>
+void Vector<T, N, A, C>::reserve(size_t n)
+{
+    if (n > cap)
+    {
+        grow(n);
+    }
+}
+
+template<typename T, size_t N, typename A, typename C>
+void Vector<T, N, A, C>::push_back(const T& x)
+{
+    emplace_back(x);
+}
+
+template<typename T, size_t N, typename A, typename C>
+void Vector<T, N, A, C>::push_back(T&& x)
+{
+    emplace_back(std::move(x));
+}
+
+// args may refer to an element, so the new one is constructed before
+// the old ones move to the larger memory
+template<typename T, size_t N, typename A, typename C>
+template<typename... Args>
+T& Vector<T, N, A, C>::emplace_back(Args&&... args)
+{
+    if (sz < cap)
+    {
+        traits::construct(alloc, elem + sz, std::forward<Args>(args)...);
+        return elem[sz++];
+    }
+    const size_t n = std::max<size_t>(2 * cap, 4);
+    T* p = traits::allocate(alloc, n);
+    try
+    {
+        traits::construct(alloc, p + sz, std::forward<Args>(args)...);
+        try
+        {
+            move_to(p, n);
+        }
+        catch (...)
+        {
+            traits::destroy(alloc, p + sz);
+            throw;
+        }
+    }
+    catch (...)
+    {
+        traits::deallocate(alloc, p, n);
+        throw;
+    }
+    return elem[sz++];
+}
+
+template<typename T, size_t N, typename A, typename C>
+void Vector<T, N, A, C>::pop_back()
+{
+    assert(sz > 0);
+    traits::destroy(alloc, elem + --sz);
+}
+
+template<typename T, size_t N, typename A, typename C>
+void Vector<T, N, A, C>::clear()
+{
+    while (sz)
+    {
+        traits::destroy(alloc, elem + --sz);
+    }
+}
+
+template<typename T, size_t N, typename A, typename C>
+T& Vector<T, N, A, C>::operator[](size_t i) const
+{
+    C::check(i, sz);
     return elem[i];
 }
 
-template<typename T>
-size_t Vector<T>::size() const
+template<typename T, size_t N, typename A, typename C>
+T& Vector<T, N, A, C>::at(size_t i) const
 {
-    return sz; 
+    Checked::check(i, sz);
+    return elem[i];
 }
 
-template<typename T>
-T* begin(Vector<T>& v)
+template<typename T, size_t N, typename A, typename C>
+size_t Vector<T, N, A, C>::size() const
 {
-    return v.size() ? &v[0] : nullptr;
+    return sz;
 }
 
-template<typename T>
-T* end(Vector<T>& v)
+template<typename T, size_t N, typename A, typename C>
+T* begin(Vector<T, N, A, C>& v)
+{
+    return v.data();
+}
+
+template<typename T, size_t N, typename A, typename C>
+T* end(Vector<T, N, A, C>& v)
 {
-    return v.size() ? &v[0]+v.size() : nullptr;
+    return v.data() + v.size();
 }
 
 }
@@ -109,9 +337,14 @@ auto create_vector()
     return v;
 }
 
-template<typename T>
-T accum(my::Vector<T>& v)
+// doubles go to the reduction kernels, and need not be added in order
+template<typename T, size_t N, typename A, typename C>
+T accum(my::Vector<T, N, A, C>& v)
 {
+    if constexpr (std::is_same_v<T, double>)
+    {
+        return my::sum({ v.data(), v.size() });
+    }
     T acc{ 0 };
     for (const auto& x : v)
     {
@@ -120,8 +353,288 @@ T accum(my::Vector<T>& v)
     return acc;
 }
 
-int main()
+// accum() on nthreads threads (0: one per core), same result for any nthreads
+template<size_t N, typename A, typename C>
+double parallel_accum(my::Vector<double, N, A, C>& v, unsigned nthreads = 0)
+{
+    return my::parallel_sum({ v.data(), v.size() }, nthreads);
+}
+
+// the same through operator[], which checks as C says
+template<typename T, size_t N, typename A, typename C>
+T accum_indexed(my::Vector<T, N, A, C>& v)
+{
+    T acc{ 0 };
+    for (size_t i = 0; i < v.size(); ++i)
+    {
+        acc += v[i];
+    }
+    return acc;
+}
+
+// counts what goes through it, to show that Vector uses its allocator
+template<typename T>
+struct Counting_allocator
+{
+    using value_type = T;
+    static inline size_t allocations = 0;
+
+    Counting_allocator() = default;
+    template<typename U>
+    Counting_allocator(const Counting_allocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        ++allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, size_t n) { std::allocator<T>{}.deallocate(p, n); }
+    bool operator==(const Counting_allocator&) const = default;
+};
+
+// unlike assert, still checks with NDEBUG, which bench is built with
+void check(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        throw std::runtime_error{ std::string{ "test: " } + what };
+    }
+}
+
+void test()
 {
     auto v1 = create_vector();
-    assert(accum(v1) == 11.0);
-}
\ No newline at end of file
+    check(accum(v1) == 11.0, "accum");
+
+    my::Vector<std::string> v2;
+    for (int i = 0; i < 100; ++i)
+    {
+        v2.push_back(std::to_string(i));
+    }
+    v2.emplace_back(v2[0]);     // refers to an element while it grows
+    check(v2.size() == 101 && v2[100] == "0" && v2[99] == "99", "emplace_back of an element");
+
+    auto v3 = v2;
+    v3 = my::Vector<std::string>{ "a", "b" };
+    check(v3.size() == 2 && v3[1] == "b", "move assignment");
+    v3 = v2;
+    check(v3.size() == 101 && v3[50] == "50", "copy assignment");
+    auto v4 = std::move(v3);
+    check(v4.size() == 101 && v3.size() == 0, "move construction");
+
+    my::Vector<int, 4, Counting_allocator<int>> v5{ 1, 2, 3 };
+    v5.push_back(4);
+    check(Counting_allocator<int>::allocations == 0, "small buffer");
+    v5.push_back(5);
+    check(Counting_allocator<int>::allocations == 1 && v5.capacity() == 8, "growth out of the small buffer");
+    auto v6 = std::move(v5);
+    check(v6.size() == 5 && v6[4] == 5 && v5.size() == 0, "move with an allocator");
+
+    my::Vector<std::unique_ptr<int>> v7;
+    for (int i = 0; i < 100; ++i)
+    {
+        v7.push_back(std::make_unique<int>(i));     // relocated by memcpy
+    }
+    check(*v7[0] == 0 && *v7[99] == 99, "relocation by memcpy");
+
+    my::Vector<int, 0, std::allocator<int>, my::Unchecked> v8{ 1, 2, 3 };
+    check(accum(v8) == 6 && accum_indexed(v8) == 6, "Unchecked access");
+    try
+    {
+        v8.at(3);
+        check(false, "at() past the end did not throw");
+    }
+    catch (std::out_of_range&) {}
+
+    // the kernels give the same results on every instruction set
+    std::mt19937 gen{ 1 };
+    std::uniform_real_distribution<double> d{ -1, 1 };
+    my::Vector<double> v9;
+    for (size_t n = 0; n < 100; ++n)
+    {
+        using namespace my::reduce_impl;
+        const double* p = v9.data();
+        check(sum_scalar(p, n) == sum_sse2(p, n) && kahan_scalar(p, n) == my::sum({ p, n }, my::Summation::kahan), "sum kernels");
+        check(dot_scalar(p, p, n) == dot_sse2(p, p, n) && dot_sse2(p, p, n) == my::dot({ p, n }, { p, n }), "dot kernels");
+        check(sum_sse2(p, n) == my::sum({ p, n }) && min_scalar(p, n) == my::min({ p, n }), "sum and min kernels");
+        check(max_scalar(p, n) == my::max({ p, n }), "max kernels");
+        v9.push_back(d(gen));
+    }
+    for (size_t n : { size_t(0), size_t(100), 3 * my::parallel_chunk + 5 })
+    {
+        v9.clear();
+        for (size_t i = 0; i < n; ++i)
+        {
+            v9.push_back(d(gen));
+        }
+        check(parallel_accum(v9, 1) == parallel_accum(v9, 3) && parallel_accum(v9) == parallel_accum(v9, 2), "parallel_accum determinism");
+    }
+}
+
+template<typename F>
+double seconds(F f)
+{
+    auto t1 = std::chrono::steady_clock::now();
+    f();
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t2 - t1).count();
+}
+
+// n push_backs into one vector, then n/4 vectors of 4 elements each
+template<typename V>
+void bench(const char* name, size_t n, typename V::value_type x)
+{
+    size_t check = 0;
+    double one = seconds([&]{
+        V v;
+        for (size_t i = 0; i < n; ++i)
+        {
+            v.push_back(x);
+        }
+        check += v.size();
+    });
+    double many = seconds([&]{
+        for (size_t i = 0; i < n / 4; ++i)
+        {
+            V v;
+            for (int j = 0; j < 4; ++j)
+            {
+                v.push_back(x);
+            }
+            check += v.size();
+        }
+    });
+    std::cout << name << ": " << one << " s, short vectors: " << many << " s\n";
+    if (check != n + n / 4 * 4)
+    {
+        std::cerr << "wrong size\n";
+    }
+}
+
+// the same as std::default_delete<int>, but is_trivially_relocatable is
+// not specialized for unique_ptrs that use it
+struct Delete_int
+{
+    void operator()(int* p) const { delete p; }
+};
+
+struct Item
+{
+    int iid;
+    double value;
+    bool operator==(const Item&) const = default;
+};
+
+// the time to move n elements to larger memory, as a push_back that
+// finds the vector full does
+template<typename V, typename F>
+void time_grow(const char* name, size_t n, F make)
+{
+    V v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        v.push_back(make(i));
+    }
+    double t = seconds([&]{ v.reserve(2 * n); });
+    std::cout << name << ": " << t << " s\n";
+    if (v.size() != n || !(v[n - 1] == make(n - 1)))
+    {
+        std::cerr << "wrong elements\n";
+    }
+}
+
+template<typename T, typename F>
+void bench_grow(const char* type, size_t n, F make)
+{
+    std::cout << "grow " << n << " " << type
+              << (my::is_trivially_relocatable_v<T> ? " (relocated by memcpy)\n" : "\n");
+    time_grow<std::vector<T>>("    std::vector", n, make);
+    time_grow<my::Vector<T>>("    my::Vector ", n, make);
+}
+
+template<typename C>
+void bench_accum(const char* name, size_t n)
+{
+    my::Vector<int, my::default_inline_capacity<int>, std::allocator<int>, C> v(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        v[i] = int(i % 100);
+    }
+    int a = 0, b = 0;
+    double t1 = seconds([&]{ a = accum(v); });
+    double t2 = seconds([&]{ b = accum_indexed(v); });
+    std::cout << name << ": accum " << t1 << " s, accum_indexed " << t2 << " s\n";
+    if (a != b)
+    {
+        std::cerr << "wrong sum\n";
+    }
+}
+
+// the kernels against the plain loop, and how far each sum is from the exact one
+void bench_reduce(size_t n)
+{
+    std::mt19937 gen{ 2 };
+    std::uniform_real_distribution<double> d{ 0, 1 };
+    my::Vector<double, 0, std::allocator<double>, my::Unchecked> v(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        v[i] = d(gen);
+    }
+    long double exact = 0;
+    for (auto x : v)
+    {
+        exact += x;
+    }
+    const std::span<const double> s{ v.data(), v.size() };
+    auto report = [&](const char* name, auto f)
+    {
+        double r = 0;
+        double t = seconds([&]{ r = f(); });
+        std::cout << name << ": " << t << " s, error " << double(std::abs(r - exact) / exact) << "\n";
+    };
+    report("sum, plain loop  ", [&]{ return accum_indexed(v); });
+    report("sum              ", [&]{ return my::sum(s); });
+    report("sum, pairwise    ", [&]{ return my::sum(s, my::Summation::pairwise); });
+    report("sum, kahan       ", [&]{ return my::sum(s, my::Summation::kahan); });
+    const double one = my::parallel_sum(s, 1);
+    for (unsigned t : { 1u, 2u, 4u, 8u })
+    {
+        double r = 0;
+        std::cout << "parallel_accum, " << t << " threads: " << seconds([&]{ r = parallel_accum(v, t); }) << " s"
+                  << (r == one ? "\n" : ", not the same sum!\n");
+    }
+    double r = 0;
+    std::cout << "min              : " << seconds([&]{ r = my::min(s); }) << " s, " << r << "\n";
+    std::cout << "max              : " << seconds([&]{ r = my::max(s); }) << " s, " << r << "\n";
+    std::cout << "dot              : " << seconds([&]{ r = my::dot(s, s); }) << " s, " << r << "\n";
+}
+
+// usage: a.out [n]
+// with n, times n push_backs into my::Vector and std::vector,
+// moving that many elements when they grow, and summing them
+int main(int argc, char* argv[])
+{
+    test();
+    if (argc < 2)
+    {
+        return 0;
+    }
+    const size_t n = std::atol(argv[1]);
+    bench<std::vector<int>>("std::vector<int>        ", n, 1);
+    bench<my::Vector<int>>("my::Vector<int>         ", n, 1);
+    bench<std::vector<std::string>>("std::vector<std::string>", n, "short");
+    bench<my::Vector<std::string>>("my::Vector<std::string> ", n, "short");
+
+    bench_grow<double>("double", n, [](size_t i){ return double(i); });
+    bench_grow<Item>("Item", n, [](size_t i){ return Item{ int(i), 0.5 }; });
+    bench_grow<std::unique_ptr<int>>("unique_ptr<int>", n, [](size_t){ return std::unique_ptr<int>{}; });
+    bench_grow<std::unique_ptr<int, Delete_int>>("unique_ptr<int, Delete_int>", n,
+        [](size_t){ return std::unique_ptr<int, Delete_int>{}; });
+    bench_grow<std::string>("string", n, [](size_t i){ return std::to_string(i); });
+
+    bench_accum<my::Checked>("Checked      ", n);
+    bench_accum<my::Debug_checked>("Debug_checked", n);
+    bench_accum<my::Unchecked>("Unchecked    ", n);
+    bench_reduce(n);
+}
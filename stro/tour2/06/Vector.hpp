@@ -1,36 +1,133 @@
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
 namespace my
 {
 
+// elements kept inside the Vector itself, enough to fill a cache line
 template<typename T>
+constexpr size_t default_inline_capacity = sizeof(T) <= 40 ? 40 / sizeof(T) : 0;
+
+// A T can be moved to new memory by copying its bytes, without calling its
+// move constructor and destructor: true for trivially copyable types, and
+// specialize it for others that do not point into themselves.
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+#ifdef _LIBCPP_VERSION
+// libstdc++'s short strings point into themselves, libc++'s do not
+template<>
+struct is_trivially_relocatable<std::string> : std::true_type {};
+#endif
+
+template<typename T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template<typename T, size_t N>
+struct Inline_buffer
+{
+    alignas(T) std::byte bytes[N * sizeof(T)];
+    T* data() { return reinterpret_cast<T*>(bytes); }
+};
+
+template<typename T>
+struct Inline_buffer<T, 0>
+{
+    T* data() { return nullptr; }
+};
+
+// What operator[] does about an index out of range. A check that can
+// throw inside a loop keeps the compiler from vectorizing it; iterating
+// from begin() to end() needs no check at all.
+struct Checked          // throw out_of_range
+{
+    static void check(size_t i, size_t n)
+    {
+        if ( i >= n )
+        {
+            throw std::out_of_range{ "Vector::operator[]" };
+        }
+    }
+};
+
+struct Debug_checked    // assert(), so nothing with NDEBUG
+{
+    static void check([[maybe_unused]] size_t i, [[maybe_unused]] size_t n) { assert(i < n); }
+};
+
+struct Unchecked
+{
+    static void check(size_t, size_t) {}
+};
+
+// Elements are constructed in place in uninitialized storage: the first N
+// in the inline buffer, then in memory from A, growing geometrically.
+template<typename T, size_t N = default_inline_capacity<T>, typename A = std::allocator<T>,
+         typename C = Checked>
 class Vector
 {
-    T* elem = nullptr;
+    using traits = std::allocator_traits<A>;
+
+    T* elem;                // buf.data() or memory from alloc
     size_t sz = 0;
+    size_t cap = N;
+    [[no_unique_address]] A alloc;
+    [[no_unique_address]] Inline_buffer<T, N> buf;
+
+    bool on_heap() const { return cap > N; }
+    void move_to(T*, size_t);
+    void grow(size_t);      // move the elements to new memory of that capacity
+    void release();         // destroy the elements and free the memory
 public:
     using value_type = T;
+    using allocator_type = A;
+    using iterator = T*;
 
-    Vector(std::initializer_list<T>);
-    explicit Vector(size_t);
+    Vector(std::initializer_list<T>, const A& = A{});
+    explicit Vector(size_t, const A& = A{});
+    explicit Vector(const A&);
     Vector();
 
-    Vector(const Vector<T>&);
-    Vector<T>& operator=(const Vector<T>&);
+    Vector(const Vector&);
+    Vector& operator=(const Vector&);
 
-    Vector(Vector<T>&&);
-    Vector<T>& operator=(Vector<T>&&);
+    Vector(Vector&&) noexcept(std::is_nothrow_move_constructible_v<T>);
+    Vector& operator=(Vector&&);
 
     inline ~Vector();
 
-    T& operator[](size_t) const;
+    T& operator[](size_t) const;     // checked as C does
+    T& at(size_t) const;             // always checked
     inline size_t size() const;
+    size_t capacity() const { return cap; }
+    bool empty() const { return sz == 0; }
+    T* data() const { return elem; }
+    T* begin() const { return elem; }
+    T* end() const { return elem + sz; }
+    A get_allocator() const { return alloc; }
+
+    void reserve(size_t);
+    void push_back(const T&);
+    void push_back(T&&);
+    template<typename... Args>
+    T& emplace_back(Args&&...);
+    void pop_back();
+    void clear();
 };
 
-template<typename T>
-T* begin(Vector<T>&);
+template<typename T, size_t N, typename A, typename C>
+T* begin(Vector<T, N, A, C>&);
 
-template<typename T>
-T* end(Vector<T>&);
+template<typename T, size_t N, typename A, typename C>
+T* end(Vector<T, N, A, C>&);
 
-}
\ No newline at end of file
+}
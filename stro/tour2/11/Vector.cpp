@@ -2,12 +2,19 @@
 
 #include <cassert>
 
+// range checked by at() in debug builds; with NDEBUG not checked at all,
+// so that it costs no more than std::vector
 template<typename T>
 class Vector : public std::vector<T>
 {
 public:
+#ifdef NDEBUG
+    T& operator[](int i) { return std::vector<T>::operator[](i); }
+    const T& operator[](int i) const { return std::vector<T>::operator[](i); }
+#else
     T& operator[](int i) { return std::vector<T>::at(i); }
     const T& operator[](int i) const { return std::vector<T>::at(i); }
+#endif
 };
 
 int main()
@@ -26,5 +33,6 @@ int main()
         a2 += v2[i];
         // terminate called after throwing an instance of 'std::out_of_range'
         //  what():  vector::_M_range_check: __n (which is 4) >= this->size() (which is 4)
+        // (unless built with NDEBUG, when this is as undefined as v1[4])
     assert(a2 == 10);  // this will not be executed
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef MY_COUNTERS_HPP
+#define MY_COUNTERS_HPP
+
+#include "event.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace my
+{
+
+// Counters that many threads add to, from the simplest to the cheapest
+// to add to; each says what get() costs and how current it is.
+
+// One atomic: every add is a locked instruction on a cache line that
+// moves between the adding cores. get() is exact and cheap.
+class Atomic_counter
+{
+    std::atomic<long> n{ 0 };
+public:
+    void add(long k = 1) { n.fetch_add(k, std::memory_order_relaxed); }
+    long get() const { return n.load(std::memory_order_relaxed); }
+};
+
+// A slot per thread, summed by get(). With Align = cache_line no two
+// threads' slots share a line, so adds do not contend; with a smaller
+// Align neighbouring slots do share one, and the line still moves
+// between cores (false sharing) although no slot is shared.
+template<size_t Align = cache_line>
+class Sharded_counter
+{
+    struct alignas(Align) Shard
+    {
+        std::atomic<long> n{ 0 };
+    };
+    size_t n_shards;
+    std::unique_ptr<Shard[]> shards;
+public:
+    explicit Sharded_counter(size_t threads) : n_shards{ threads }, shards{ new Shard[threads] } {}
+
+    // thread is the adding thread's slot, in [0, threads)
+    void add(size_t thread, long k = 1) { shards[thread].n.fetch_add(k, std::memory_order_relaxed); }
+
+    // exact once the adding threads are done; while they run, a sum of
+    // slots read at slightly different times
+    long get() const
+    {
+        long s = 0;
+        for (size_t i = 0; i < n_shards; ++i)
+        {
+            s += shards[i].n.load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+};
+
+// Each thread counts in a Local of its own, a plain long, and adds it to
+// the shared total once, when it is flushed or destroyed. get() misses
+// whatever has not been flushed yet.
+class Local_counter
+{
+    std::atomic<long> total{ 0 };
+public:
+    class Local
+    {
+        Local_counter& c;
+        long n = 0;
+    public:
+        explicit Local(Local_counter& counter) : c{ counter } {}
+        Local(const Local&) = delete;
+        Local& operator=(const Local&) = delete;
+        ~Local() { flush(); }
+
+        void add(long k = 1) { n += k; }
+        void flush()
+        {
+            c.total.fetch_add(n, std::memory_order_relaxed);
+            n = 0;
+        }
+    };
+
+    long get() const { return total.load(std::memory_order_relaxed); }
+};
+
+}
+
+#endif
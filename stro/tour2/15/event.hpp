@@ -0,0 +1,57 @@
+#ifndef MY_EVENT_HPP
+#define MY_EVENT_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace my
+{
+
+// what two atomics written by different threads keep apart, so that
+// they do not share a cache line
+constexpr size_t cache_line = 64;
+
+// An event count: lets a thread sleep until another makes a condition
+// true, without a mutex, and costs the other thread only a fence and a
+// load while nobody sleeps.
+//     auto key = e.prepare_wait();
+//     if (condition) e.cancel_wait(); else e.wait(key);
+// and after making the condition true, e.notify(). The waiter must read
+// the condition with seq_cst loads: either it sees the condition true or
+// notify() sees it waiting.
+class Event
+{
+    std::atomic<unsigned> epoch{ 0 };
+    std::atomic<unsigned> waiters{ 0 };
+public:
+    unsigned prepare_wait()
+    {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_acquire);
+    }
+    void cancel_wait() { waiters.fetch_sub(1, std::memory_order_relaxed); }
+    void wait(unsigned key)
+    {
+        epoch.wait(key, std::memory_order_acquire);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed))
+        {
+            wake();
+        }
+    }
+    // wakes waiters whether or not a condition changed, e.g. to stop them
+    void wake()
+    {
+        epoch.fetch_add(1, std::memory_order_release);
+        epoch.notify_all();
+    }
+};
+
+}
+
+#endif
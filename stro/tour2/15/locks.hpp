@@ -0,0 +1,233 @@
+#ifndef MY_LOCKS_HPP
+#define MY_LOCKS_HPP
+
+#include "event.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace my
+{
+
+// Mutexes with lock(), try_lock() and unlock(), so std::scoped_lock and
+// std::unique_lock take any of them. The spinning ones suit sections of
+// a few instructions on threads that have a core each; when there are
+// more runnable threads than cores they yield, but still lose time to
+// waiters that are not running.
+
+// tells the core we are spinning: frees the pipeline for the hyperthread
+// next door and costs less power than a tight loop
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+// waits a little longer each time it is called, then yields the core
+class Backoff
+{
+    unsigned spins = 1;
+public:
+    static constexpr unsigned max_spins = 64;
+    void operator()()
+    {
+        if (spins <= max_spins)
+        {
+            for (unsigned i = 0; i < spins; ++i)
+            {
+                cpu_relax();
+            }
+            spins *= 2;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+};
+
+// test-and-test-and-set: waiters spin reading their cached copy of the
+// flag and only try the exchange, which takes the line, once it is clear.
+// Not fair: whoever tries first after an unlock wins.
+class Ttas_lock
+{
+    std::atomic<bool> locked{ false };
+public:
+    bool try_lock()
+    {
+        return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+    }
+    void lock()
+    {
+        for (Backoff backoff; !try_lock(); )
+        {
+            backoff();
+        }
+    }
+    void unlock() { locked.store(false, std::memory_order_release); }
+};
+
+// first come, first served: lock() takes a ticket and waits for it to be
+// served. Every waiter reads the same serving counter, so each unlock
+// sends a miss to all of them.
+class Ticket_lock
+{
+    alignas(cache_line) std::atomic<unsigned> next{ 0 };
+    alignas(cache_line) std::atomic<unsigned> serving{ 0 };
+public:
+    bool try_lock()
+    {
+        unsigned s = serving.load(std::memory_order_relaxed);
+        return next.compare_exchange_strong(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    void lock()
+    {
+        const unsigned ticket = next.fetch_add(1, std::memory_order_relaxed);
+        for (Backoff backoff; serving.load(std::memory_order_acquire) != ticket; )
+        {
+            backoff();
+        }
+    }
+    void unlock()
+    {
+        serving.store(serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+// Mellor-Crummey and Scott: first come, first served like Ticket_lock,
+// but waiters queue up in a list and each spins on a flag in its own node,
+// so an unlock touches only the next waiter's cache line.
+class Mcs_lock
+{
+    struct alignas(cache_line) Node
+    {
+        std::atomic<Node*> next{ nullptr };
+        std::atomic<bool> waiting{ false };
+    };
+
+    // nodes this thread is not using, so that a thread may hold any number
+    // of Mcs_locks without allocating on each lock()
+    class Node_pool
+    {
+        std::vector<std::unique_ptr<Node>> free;
+    public:
+        Node* take()
+        {
+            if (free.empty())
+            {
+                return new Node;
+            }
+            Node* n = free.back().release();
+            free.pop_back();
+            n->next.store(nullptr, std::memory_order_relaxed);
+            return n;
+        }
+        void give(Node* n) { free.emplace_back(n); }
+    };
+    static Node_pool& node_pool()
+    {
+        thread_local Node_pool pool;
+        return pool;
+    }
+
+    std::atomic<Node*> tail{ nullptr };
+    Node* holder = nullptr;     // written by whoever holds the lock
+public:
+    bool try_lock()
+    {
+        Node* me = node_pool().take();
+        Node* expected = nullptr;
+        if (!tail.compare_exchange_strong(expected, me, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            node_pool().give(me);
+            return false;
+        }
+        holder = me;
+        return true;
+    }
+    void lock()
+    {
+        Node* me = node_pool().take();
+        me->waiting.store(true, std::memory_order_relaxed);
+        if (Node* prev = tail.exchange(me, std::memory_order_acq_rel))
+        {
+            prev->next.store(me, std::memory_order_release);
+            for (Backoff backoff; me->waiting.load(std::memory_order_acquire); )
+            {
+                backoff();
+            }
+        }
+        holder = me;
+    }
+    void unlock()
+    {
+        Node* me = holder;
+        Node* next = me->next.load(std::memory_order_acquire);
+        if (!next)
+        {
+            Node* expected = me;
+            if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed))
+            {
+                node_pool().give(me);
+                return;
+            }
+            // a thread has swapped itself in but not linked to us yet
+            for (Backoff backoff; !(next = me->next.load(std::memory_order_acquire)); )
+            {
+                backoff();
+            }
+        }
+        next->waiting.store(false, std::memory_order_release);
+        node_pool().give(me);
+    }
+};
+
+// Drepper's three-state mutex ("Futexes are tricky"): 0 free, 1 locked,
+// 2 locked with sleepers. It spins briefly, in case the holder is about
+// to leave, then sleeps in the kernel through std::atomic::wait, which is
+// a futex on Linux. unlock() makes a system call only if someone sleeps.
+class Futex_mutex
+{
+    std::atomic<int> state{ 0 };
+public:
+    static constexpr int spins = 100;
+
+    bool try_lock()
+    {
+        int c = 0;
+        return state.compare_exchange_strong(c, 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    void lock()
+    {
+        for (int i = 0; i < spins; ++i)
+        {
+            if (state.load(std::memory_order_relaxed) == 0 && try_lock())
+            {
+                return;
+            }
+            cpu_relax();
+        }
+        // from now on we may have to sleep, so leave 2 behind us
+        while (state.exchange(2, std::memory_order_acquire) != 0)
+        {
+            state.wait(2, std::memory_order_relaxed);
+        }
+    }
+    void unlock()
+    {
+        if (state.exchange(0, std::memory_order_release) == 2)
+        {
+            state.notify_one();
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef MY_MPMC_QUEUE_HPP
+#define MY_MPMC_QUEUE_HPP
+
+#include "event.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <thread>
+
+namespace my
+{
+
+// A bounded queue for any number of producers and consumers, after
+// Dmitry Vyukov's: every cell has a sequence number that says whose turn
+// it is, so a push or pop claims a position with one CAS and then owns the
+// cell, and producers and consumers meet only when the queue is nearly
+// full or empty.
+template<typename T>
+class Mpmc_queue
+{
+    struct Cell
+    {
+        // pos: free for the push at pos; pos + 1: holds the push at pos
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+
+    alignas(cache_line) std::atomic<size_t> enqueue_pos{ 0 };
+    alignas(cache_line) std::atomic<size_t> dequeue_pos{ 0 };
+    alignas(cache_line) Event not_empty;
+    Event not_full;
+
+    static std::intptr_t diff(size_t a, size_t b) { return std::intptr_t(a - b); }
+public:
+    // capacity is rounded up to a power of 2
+    explicit Mpmc_queue(size_t capacity = 1024)
+        : mask{ std::bit_ceil(std::max<size_t>(capacity, 2)) - 1 }
+        , cells{ new Cell[mask + 1] }
+    {
+        for (size_t i = 0; i <= mask; ++i)
+        {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    Mpmc_queue(const Mpmc_queue&) = delete;
+    Mpmc_queue& operator=(const Mpmc_queue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // false if the queue is full
+    bool try_push(const T& x)
+    {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Cell* c;
+        for (;;)
+        {
+            c = &cells[pos & mask];
+            const std::intptr_t d = diff(c->seq.load(std::memory_order_acquire), pos);
+            if (d == 0)
+            {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (d < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        c->data = x;
+        c->seq.store(pos + 1, std::memory_order_release);
+        not_empty.notify();
+        return true;
+    }
+
+    // false if the queue is empty
+    bool try_pop(T& x)
+    {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell* c;
+        for (;;)
+        {
+            c = &cells[pos & mask];
+            const std::intptr_t d = diff(c->seq.load(std::memory_order_acquire), pos + 1);
+            if (d == 0)
+            {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (d < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        x = std::move(c->data);
+        c->seq.store(pos + mask + 1, std::memory_order_release);
+        not_full.notify();
+        return true;
+    }
+
+    // sleeps while the queue is full; false if stop was requested first
+    bool push(const T& x, std::stop_token stop = {})
+    {
+        for (;;)
+        {
+            if (try_push(x))
+            {
+                return true;
+            }
+            const unsigned key = not_full.prepare_wait();
+            if (diff(enqueue_pos.load(), dequeue_pos.load()) < std::intptr_t(capacity()))
+            {
+                // room, or a pop that has claimed a cell but not freed it yet
+                not_full.cancel_wait();
+                std::this_thread::yield();
+                continue;
+            }
+            std::stop_callback wake_on_stop{ stop, [this]{ not_full.wake(); } };
+            if (stop.stop_requested())
+            {
+                not_full.cancel_wait();
+                return false;
+            }
+            not_full.wait(key);
+        }
+    }
+
+    // sleeps while the queue is empty; false once stop is requested and
+    // the queue is empty, as the consumer in queue.cpp stops
+    bool pop(T& x, std::stop_token stop)
+    {
+        for (;;)
+        {
+            if (try_pop(x))
+            {
+                return true;
+            }
+            const unsigned key = not_empty.prepare_wait();
+            if (enqueue_pos.load() != dequeue_pos.load())
+            {
+                // a push that has claimed a cell but not filled it yet
+                not_empty.cancel_wait();
+                std::this_thread::yield();
+                continue;
+            }
+            std::stop_callback wake_on_stop{ stop, [this]{ not_empty.wake(); } };
+            if (stop.stop_requested())
+            {
+                not_empty.cancel_wait();
+                return try_pop(x);
+            }
+            not_empty.wait(key);
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <string_view>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+double seconds(F f)
+{
+    auto t1 = Clock::now();
+    f();
+    return std::chrono::duration<double>(Clock::now() - t1).count();
+}
+
+long square(long i) { return i * i; }
+
+void check(long got, long n)
+{
+    if (got != (n - 1) * n * (2 * n - 1) / 6)
+    {
+        throw std::runtime_error{ "pool_bench: wrong sum" };
+    }
+}
+
+// n tiny tasks, each with its own future
+double pool_tasks(my::Thread_pool& pool, long n)
+{
+    return seconds([&]{
+        std::vector<std::future<long>> fs;
+        fs.reserve(n);
+        for (long i = 0; i < n; ++i)
+        {
+            fs.push_back(pool.submit([i]{ return square(i); }));
+        }
+        long s = 0;
+        for (auto& f : fs)
+        {
+            s += f.get();
+        }
+        check(s, n);
+    });
+}
+
+double async_tasks(long n)
+{
+    return seconds([&]{
+        std::vector<std::future<long>> fs;
+        fs.reserve(n);
+        for (long i = 0; i < n; ++i)
+        {
+            fs.push_back(std::async(std::launch::async, square, i));
+        }
+        long s = 0;
+        for (auto& f : fs)
+        {
+            s += f.get();
+        }
+        check(s, n);
+    });
+}
+
+// tasks that make tasks: the case stealing is for
+long fib(my::Thread_pool& pool, int n)
+{
+    if (n < 2)
+    {
+        return n;
+    }
+    auto a = pool.submit([&pool, n]{ return fib(pool, n - 1); });
+    const long b = fib(pool, n - 2);
+    return pool.get(a) + b;
+}
+
+long fib(int n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+
+// usage: pool_bench [n] [pin]
+// n (default 1'000'000) tiny tasks on the pool, a hundredth as many (at
+// most 10'000) through std::async, then fib(25) a task per call and a parallel_for over n
+int main(int argc, char* argv[])
+{
+    const long n = argc > 1 ? std::atol(argv[1]) : 1'000'000;
+    const bool pin = argc > 2 && std::string_view{ argv[2] } == "pin";
+    my::Thread_pool pool{ 0, pin };
+    std::cout << pool.size() << " workers" << (pin ? ", pinned" : "") << '\n';
+
+    const double tp = pool_tasks(pool, n);
+    std::cout << "pool.submit:      " << n / tp / 1e6 << " M tasks/s\n";
+    // a thread per task: more at once than the system allows
+    const long na = std::clamp(n / 100, 1L, 10'000L);
+    const double ta = async_tasks(na);
+    std::cout << "std::async:       " << na / ta / 1e6 << " M tasks/s\n";
+
+    long f = 0;
+    const double tf = seconds([&]{ f = fib(pool, 25); });
+    if (f != fib(25))
+    {
+        throw std::runtime_error{ "pool_bench: wrong fib" };
+    }
+    // a task for each call with n >= 2: fib(26) - 1 of them
+    std::cout << "fib(25) tasks:    " << tf * 1e3 << " ms, "
+              << (fib(26) - 1) / tf / 1e6 << " M tasks/s\n";
+    // again from a thread of our own: waiting outside the pool must block,
+    // not run the pool's tasks on that thread's stack
+    f = 0;
+    std::jthread{ [&]{ f = fib(pool, 25); } }.join();
+    if (f != fib(25))
+    {
+        throw std::runtime_error{ "pool_bench: wrong fib from outside the pool" };
+    }
+
+    // tasks that wait for tasks submitted after them, one per worker:
+    // the waiting workers must run those themselves
+    {
+        std::promise<void> ready;
+        std::shared_future<void> go = ready.get_future().share();
+        std::vector<std::future<long>> later(pool.size());
+        std::vector<std::future<long>> waiting;
+        for (size_t i = 0; i < pool.size(); ++i)
+        {
+            waiting.push_back(pool.submit([&pool, &later, go, i]{
+                go.wait();
+                return pool.get(later[i]);
+            }));
+        }
+        for (size_t i = 0; i < pool.size(); ++i)
+        {
+            later[i] = pool.submit([i]{ return square(long(i)); });
+        }
+        ready.set_value();
+        for (size_t i = 0; i < pool.size(); ++i)
+        {
+            if (waiting[i].get() != square(long(i)))
+            {
+                throw std::runtime_error{ "pool_bench: wrong result of a waiting task" };
+            }
+        }
+    }
+
+    std::vector<long> v(n);
+    const double tl = seconds([&]{ pool.parallel_for(0, n, [&](size_t i){ v[i] = square(long(i)); }); });
+    long s = 0;
+    for (long x : v)
+    {
+        s += x;
+    }
+    check(s, n);
+    std::cout << "parallel_for:     " << n / tl / 1e6 << " M indices/s\n";
+}
@@ -19,39 +19,40 @@ inline std::istream& operator>>(std::istream& is, message& m)
 #include <queue>
 #include <condition_variable>
 #include <mutex>
+#include <stop_token>
 
 std::queue<message> mq;
-std::condition_variable mcond;
+std::condition_variable_any mcond;
 std::mutex mmutex;
 
-void consumer(std::stop_token stop_token)
+// takes everything that has arrived under one lock and prints it unlocked
+void locked_consumer(std::stop_token stop_token)
 {
+    std::queue<message> batch;
     while (true)
     {
-        // acquire mmutex
-        std::unique_lock lck{mmutex};
-
-        // release lck and wait
-        // re-acquire lck upon wakeup
-        mcond.wait(lck);
-
-        if (stop_token.stop_requested())
         {
-            return;
+            std::unique_lock lck{mmutex};
+
+            // the predicate is checked under the lock before every wait, so a
+            // push between two waits is not missed; a stop request wakes the
+            // wait too, but we leave only once the queue is empty
+            if (!mcond.wait(lck, stop_token, []{ return !mq.empty(); }))
+            {
+                return;
+            }
+            batch.swap(mq);
         }
-        else if (!mq.empty())
+
+        for (; !batch.empty(); batch.pop())
         {
-            auto m = mq.front();
-            mq.pop();
-            std::cout << '>' << m << '\n' << std::flush;
+            std::cout << '>' << batch.front() << '\n';
         }
-
-        // release the lock
-        lck.unlock();
+        std::cout << std::flush;
     }
 }
 
-void producer()
+void locked_producer()
 {
     while (true)
     {
@@ -73,14 +74,139 @@ void producer()
     }
 }
 
+#include "spsc_queue.hpp"
+
+// no lock: the consumer takes whatever has arrived, up to a batch at a time
+my::Spsc_queue<message> ring{ 4096 };
+
+void consumer(std::stop_token stop_token)
+{
+    message batch[256];
+    while (std::size_t n = ring.pop(batch, stop_token))
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::cout << '>' << batch[i] << '\n';
+        }
+        std::cout << std::flush;
+    }
+}
+
+void producer()
+{
+    message msg;
+    while (std::cin >> msg)
+    {
+        ring.push(msg);
+    }
+}
+
+#include <unistd.h>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <memory>
+#include <span>
+
+// whole reads of stdin, passed between the threads by pointer: the
+// producer takes a block from free_blocks, fills it and hands it over in
+// full_blocks; the consumer prints it and gives it back
+struct Block
+{
+    std::array<char, 1 << 16> bytes;
+    std::size_t size = 0;
+};
+
+constexpr std::size_t pool_size = 8;
+std::unique_ptr<Block[]> pool{ new Block[pool_size] };
+my::Spsc_queue<Block*> full_blocks{ pool_size };
+my::Spsc_queue<Block*> free_blocks{ pool_size };
+
+void block_consumer(std::stop_token stop_token)
+{
+    Block* b;
+    while (full_blocks.pop(std::span{ &b, 1 }, stop_token))
+    {
+        for (char c : std::span{ b->bytes.data(), b->size })
+        {
+            std::cout << '>' << message{ c } << '\n';
+        }
+        std::cout << std::flush;
+        free_blocks.push(b);
+    }
+}
+
+// one read(2) and one push per block instead of one extraction and one
+// push per message; whitespace is dropped as std::cin >> msg drops it
+void block_producer()
+{
+    for (std::size_t i = 0; i < pool_size; ++i)
+    {
+        free_blocks.push(&pool[i]);
+    }
+    for (Block* b; free_blocks.pop(std::span{ &b, 1 }, {}); )
+    {
+        const ssize_t n = read(STDIN_FILENO, b->bytes.data(), b->bytes.size());
+        if (n < 0 && errno == EINTR)
+        {
+            free_blocks.push(b);
+            continue;
+        }
+        if (n <= 0)
+        {
+            return;
+        }
+        b->size = 0;
+        for (ssize_t i = 0; i < n; ++i)
+        {
+            const char c = b->bytes[i];
+            if (!std::isspace(static_cast<unsigned char>(c)))
+            {
+                b->bytes[b->size++] = c;
+            }
+        }
+        if (b->size)
+        {
+            full_blocks.push(b);
+        }
+        else
+        {
+            free_blocks.push(b);
+        }
+    }
+}
+
 #include <thread>
+#include <string_view>
 
-int main()
+// usage: queue [ring|mutex]
+// echoes the characters of stdin as lines ">c", read a block at a time
+// and passed through a ring buffer, or a character at a time through the
+// ring, or a character at a time through the std::queue under a mutex
+int main(int argc, char* argv[])
 {
-    std::jthread thread_consumer{ consumer };
-    std::jthread thread_producer{ producer };
+    const std::string_view mode = argc > 1 ? argv[1] : "";
+    if (mode == "mutex")
+    {
+        std::jthread thread_consumer{ locked_consumer };
+        std::jthread thread_producer{ locked_producer };
+        thread_producer.join();
+        thread_consumer.request_stop();     // it stops once mq is empty
+        thread_consumer.join();
+        return 0;
+    }
+    if (mode == "ring")
+    {
+        std::jthread thread_consumer{ consumer };
+        std::jthread thread_producer{ producer };
+        thread_producer.join();
+        thread_consumer.request_stop();     // it stops once the ring is empty
+        thread_consumer.join();
+        return 0;
+    }
+    std::jthread thread_consumer{ block_consumer };
+    std::jthread thread_producer{ block_producer };
     thread_producer.join();
-    thread_consumer.request_stop();
-    mcond.notify_one();
+    thread_consumer.request_stop();     // it stops once full_blocks is empty
     thread_consumer.join();
 }
@@ -0,0 +1,287 @@
+#include "mpmc_queue.hpp"
+#include "spsc_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// a message that knows when it was sent
+struct Stamped
+{
+    std::int64_t sent = 0;      // ns since the start
+};
+
+const Clock::time_point start = Clock::now();
+
+std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// queue.cpp's std::queue, mutex and condition_variable, but waiting on a
+// predicate so that no message is lost
+template<typename T>
+class Locked_queue
+{
+    std::queue<T> q;
+    std::mutex m;
+    std::condition_variable c;
+    bool stopped = false;
+public:
+    void push(const T& x)
+    {
+        std::scoped_lock lck{ m };
+        q.push(x);
+        c.notify_one();
+    }
+    bool pop(T& x)
+    {
+        std::unique_lock lck{ m };
+        c.wait(lck, [&]{ return !q.empty() || stopped; });
+        if (q.empty())
+        {
+            return false;
+        }
+        x = q.front();
+        q.pop();
+        return true;
+    }
+    // swaps out everything queued, as queue.cpp's consumer does; false once
+    // stopped and empty
+    bool pop_all(std::queue<T>& out)
+    {
+        std::unique_lock lck{ m };
+        c.wait(lck, [&]{ return !q.empty() || stopped; });
+        if (q.empty())
+        {
+            return false;
+        }
+        out.swap(q);
+        return true;
+    }
+    // stopped by stop(), not by the token
+    bool pop(T& x, std::stop_token) { return pop(x); }
+    void stop()
+    {
+        std::scoped_lock lck{ m };
+        stopped = true;
+        c.notify_all();
+    }
+};
+
+struct Result
+{
+    double seconds;
+    std::vector<std::int64_t> latencies;
+};
+
+void report(const std::string& name, size_t n, Result& r)
+{
+    auto& l = r.latencies;
+    std::sort(l.begin(), l.end());
+    auto at = [&](double q){ return l[std::min(l.size() - 1, size_t(q * l.size()))] / 1000.0; };
+    std::cout << name << ": " << n / r.seconds / 1e6 << " M msg/s, latency us p50 " << at(0.5)
+              << " p99 " << at(0.99) << " p99.9 " << at(0.999) << " max " << at(1) << '\n';
+}
+
+// n messages through the queue.cpp pattern
+Result run_locked(size_t n)
+{
+    Locked_queue<Stamped> q;
+    Result r;
+    r.latencies.reserve(n);
+    auto t1 = Clock::now();
+    std::jthread consumer{ [&]{
+        for (Stamped s; q.pop(s); )
+        {
+            r.latencies.push_back(now_ns() - s.sent);
+        }
+    } };
+    for (size_t i = 0; i < n; ++i)
+    {
+        q.push(Stamped{ now_ns() });
+    }
+    q.stop();
+    consumer.join();
+    r.seconds = std::chrono::duration<double>(Clock::now() - t1).count();
+    return r;
+}
+
+// n messages through the ring, pushed batch at a time
+Result run_spsc(size_t n, size_t batch)
+{
+    my::Spsc_queue<Stamped> q{ 4096 };
+    Result r;
+    r.latencies.reserve(n);
+    auto t1 = Clock::now();
+    std::jthread consumer{ [&](std::stop_token stop){
+        Stamped got[256];
+        while (size_t k = q.pop(got, stop))
+        {
+            const std::int64_t t = now_ns();
+            for (size_t i = 0; i < k; ++i)
+            {
+                r.latencies.push_back(t - got[i].sent);
+            }
+        }
+    } };
+    std::vector<Stamped> out(batch);
+    for (size_t i = 0; i < n; i += batch)
+    {
+        const size_t k = std::min(batch, n - i);
+        const std::int64_t t = now_ns();
+        for (size_t j = 0; j < k; ++j)
+        {
+            out[j].sent = t;
+        }
+        q.push(std::span<const Stamped>{ out.data(), k });
+    }
+    consumer.request_stop();
+    consumer.join();
+    r.seconds = std::chrono::duration<double>(Clock::now() - t1).count();
+    return r;
+}
+
+// n messages pushed in bursts of burst with a pause between, popped one
+// at a time under the lock or drained a queue at a time
+Result run_bursty(size_t n, size_t burst, bool drain)
+{
+    Locked_queue<Stamped> q;
+    Result r;
+    r.latencies.reserve(n);
+    auto t1 = Clock::now();
+    std::jthread consumer{ [&]{
+        if (drain)
+        {
+            for (std::queue<Stamped> batch; q.pop_all(batch); )
+            {
+                for (; !batch.empty(); batch.pop())
+                {
+                    r.latencies.push_back(now_ns() - batch.front().sent);
+                }
+            }
+        }
+        else
+        {
+            for (Stamped s; q.pop(s); )
+            {
+                r.latencies.push_back(now_ns() - s.sent);
+            }
+        }
+    } };
+    for (size_t i = 0; i < n; ++i)
+    {
+        q.push(Stamped{ now_ns() });
+        if ((i + 1) % burst == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds{ 100 });
+        }
+    }
+    q.stop();
+    consumer.join();
+    r.seconds = std::chrono::duration<double>(Clock::now() - t1).count();
+    return r;
+}
+
+// n messages from threads / 2 producers to threads - threads / 2 consumers;
+// returns the seconds taken
+template<typename Queue>
+double run_many(size_t n, unsigned threads)
+{
+    Queue q;
+    const unsigned producers = std::max(1u, threads / 2);
+    const unsigned consumers = std::max(1u, threads - producers);
+    std::atomic<size_t> received{ 0 };
+    auto t1 = Clock::now();
+    std::vector<std::jthread> cs;
+    for (unsigned i = 0; i < consumers; ++i)
+    {
+        cs.emplace_back([&](std::stop_token stop){
+            size_t k = 0;
+            for (Stamped s; q.pop(s, stop); )
+            {
+                ++k;
+            }
+            received += k;
+        });
+    }
+    {
+        std::vector<std::jthread> ps;
+        for (unsigned i = 0; i < producers; ++i)
+        {
+            ps.emplace_back([&, i]{
+                for (size_t j = i; j < n; j += producers)
+                {
+                    q.push(Stamped{ std::int64_t(j) });
+                }
+            });
+        }
+    }
+    for (auto& c : cs)
+    {
+        c.request_stop();
+    }
+    if constexpr (requires { q.stop(); })
+    {
+        q.stop();
+    }
+    cs.clear();
+    if (received != n)
+    {
+        throw std::runtime_error{ "run_many: lost messages" };
+    }
+    return std::chrono::duration<double>(Clock::now() - t1).count();
+}
+
+// bursts pause 100us each, so they get a count of their own
+constexpr size_t bursty_messages = 100'000;
+
+// usage: queue_bench [n]
+// passes n messages (default 10'000'000, at least 1) from one thread to
+// another in a stream, and min(n, bursty_messages) in bursts, then n
+// among 2 to 64 threads, half of them producers
+int main(int argc, char* argv[])
+{
+    const long arg = argc > 1 ? std::atol(argv[1]) : 10'000'000;
+    if (arg < 1)
+    {
+        std::cerr << "usage: queue_bench [n], n >= 1\n";
+        return 1;
+    }
+    const size_t n = arg;
+    std::cout << n << " messages, " << std::thread::hardware_concurrency() << " cores\n";
+    Result r = run_locked(n);
+    report("mutex queue         ", n, r);
+    r = run_spsc(n, 1);
+    report("ring, 1 at a time   ", n, r);
+    r = run_spsc(n, 64);
+    report("ring, 64 at a time  ", n, r);
+    const size_t nb = std::min(n, bursty_messages);
+    for (size_t burst : { 16, 1024 })
+    {
+        std::cout << nb << " messages in bursts of " << burst << ", 100us apart\n";
+        r = run_bursty(nb, burst, false);
+        report("mutex, 1 at a time  ", nb, r);
+        r = run_bursty(nb, burst, true);
+        report("mutex, drained      ", nb, r);
+    }
+
+    std::cout << "threads  mutex M msg/s  mpmc M msg/s\n";
+    for (unsigned t = 2; t <= 64; t *= 2)
+    {
+        const double locked = run_many<Locked_queue<Stamped>>(n, t);
+        const double mpmc = run_many<my::Mpmc_queue<Stamped>>(n, t);
+        std::cout << t << '\t' << n / locked / 1e6 << '\t' << n / mpmc / 1e6 << '\n';
+    }
+}
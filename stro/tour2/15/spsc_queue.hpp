@@ -0,0 +1,147 @@
+#ifndef MY_SPSC_QUEUE_HPP
+#define MY_SPSC_QUEUE_HPP
+
+#include "event.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stop_token>
+
+namespace my
+{
+
+// A bounded queue for exactly one producer thread and one consumer thread.
+// Each side owns one index and reads the other's with acquire, keeping a
+// cached copy so that it touches the other's cache line only when the
+// queue looks full (or empty). Batches cost one release store each.
+template<typename T>
+class Spsc_queue
+{
+    const size_t mask;
+    std::unique_ptr<T[]> ring;
+
+    alignas(cache_line) std::atomic<size_t> tail{ 0 };     // written by the producer
+    size_t head_seen = 0;
+    alignas(cache_line) std::atomic<size_t> head{ 0 };     // written by the consumer
+    size_t tail_seen = 0;
+
+    alignas(cache_line) Event not_empty;
+    Event not_full;
+public:
+    // capacity is rounded up to a power of 2
+    explicit Spsc_queue(size_t capacity = 1024)
+        : mask{ std::bit_ceil(std::max<size_t>(capacity, 2)) - 1 }
+        , ring{ new T[mask + 1] }
+    {}
+    Spsc_queue(const Spsc_queue&) = delete;
+    Spsc_queue& operator=(const Spsc_queue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // producer: pushes as many of in as fit; returns how many
+    size_t try_push(std::span<const T> in)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head_seen + in.size() > capacity())
+        {
+            head_seen = head.load(std::memory_order_acquire);
+        }
+        const size_t n = std::min(in.size(), capacity() - (t - head_seen));
+        for (size_t i = 0; i < n; ++i)
+        {
+            ring[(t + i) & mask] = in[i];
+        }
+        if (n)
+        {
+            tail.store(t + n, std::memory_order_release);
+            not_empty.notify();
+        }
+        return n;
+    }
+    bool try_push(const T& x) { return try_push(std::span<const T>{ &x, 1 }) == 1; }
+
+    // consumer: pops up to out.size(); returns how many
+    size_t try_pop(std::span<T> out)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (tail_seen - h < out.size())
+        {
+            tail_seen = tail.load(std::memory_order_acquire);
+        }
+        const size_t n = std::min(out.size(), tail_seen - h);
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = std::move(ring[(h + i) & mask]);
+        }
+        if (n)
+        {
+            head.store(h + n, std::memory_order_release);
+            not_full.notify();
+        }
+        return n;
+    }
+    bool try_pop(T& x) { return try_pop(std::span<T>{ &x, 1 }) == 1; }
+
+    // producer: pushes all of in, sleeping while the queue is full
+    void push(std::span<const T> in)
+    {
+        while (!in.empty())
+        {
+            const size_t n = try_push(in);
+            in = in.subspan(n);
+            if (n == 0)
+            {
+                const unsigned key = not_full.prepare_wait();
+                // seq_cst, not acquire: otherwise this load and the
+                // consumer's check of the waiter count in notify() may
+                // both read stale values and we sleep through its pop
+                if (tail.load(std::memory_order_relaxed) - head.load() < capacity())
+                {
+                    not_full.cancel_wait();
+                }
+                else
+                {
+                    not_full.wait(key);
+                }
+            }
+        }
+    }
+    void push(const T& x) { push(std::span<const T>{ &x, 1 }); }
+
+    // consumer: pops at least one and up to out.size(), sleeping while the
+    // queue is empty; returns 0 only once stop is requested and it is empty
+    size_t pop(std::span<T> out, std::stop_token stop)
+    {
+        for (;;)
+        {
+            if (const size_t n = try_pop(out))
+            {
+                return n;
+            }
+            const unsigned key = not_empty.prepare_wait();
+            // seq_cst for the same reason as in push()
+            if (tail.load() != head.load(std::memory_order_relaxed))
+            {
+                not_empty.cancel_wait();
+            }
+            else
+            {
+                // runs at once if stop was already requested
+                std::stop_callback wake_on_stop{ stop, [this]{ not_empty.wake(); } };
+                if (stop.stop_requested())
+                {
+                    not_empty.cancel_wait();
+                    return try_pop(out);
+                }
+                not_empty.wait(key);
+            }
+        }
+    }
+};
+
+}
+
+#endif
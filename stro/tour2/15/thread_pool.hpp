@@ -0,0 +1,389 @@
+#ifndef MY_THREAD_POOL_HPP
+#define MY_THREAD_POOL_HPP
+
+#include "event.hpp"
+#include "mpmc_queue.hpp"
+#include "ws_deque.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace my
+{
+
+// A fixed set of worker threads that share out tasks by stealing. A task
+// submitted by a worker goes on the bottom of that worker's own deque and
+// is usually run by the same worker, hot in its cache; an idle worker
+// steals from the top of someone else's, taking the oldest (and, for
+// divide-and-conquer work, biggest) task. Tasks submitted from outside
+// the pool go through a shared Mpmc_queue.
+// The destructor runs every task already submitted, then joins.
+class Thread_pool
+{
+    struct Task
+    {
+        virtual ~Task() = default;
+        virtual void run() = 0;
+    };
+    template<typename F>
+    struct Task_of final : Task
+    {
+        F f;
+        explicit Task_of(F&& g) : f{ std::move(g) } {}
+        void run() override { f(); }
+    };
+    struct alignas(cache_line) Worker
+    {
+        Ws_deque<Task*> deque;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    Mpmc_queue<Task*> injected{ 4096 };
+    // submitted and not yet taken; counted before the task is queued, so
+    // a worker that sees 0 after prepare_wait() is sure to be notified
+    alignas(cache_line) std::atomic<size_t> queued{ 0 };
+    Event work_available;
+    // a task has finished: wakes threads outside the pool that wait in
+    // run_until()
+    Event task_done;
+    std::stop_source stopping;
+    std::vector<std::jthread> threads;
+
+    static inline thread_local Thread_pool* current_pool = nullptr;
+    static inline thread_local size_t current_worker = 0;
+    // tasks run by run_until() inside one another on this thread
+    static inline thread_local size_t nesting = 0;
+
+    void enqueue(Task* t)
+    {
+        queued.fetch_add(1, std::memory_order_seq_cst);
+        if (current_pool == this)
+        {
+            workers[current_worker]->deque.push(t);
+        }
+        else
+        {
+            injected.push(t);
+        }
+        work_available.notify();
+    }
+
+    // the bottom of this worker's own deque only
+    bool take_own(Task*& t)
+    {
+        if (current_pool == this && workers[current_worker]->deque.take(t))
+        {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // own deque first, then the shared queue, then the other workers
+    bool find_work(Task*& t)
+    {
+        const bool mine = current_pool == this;
+        bool found = mine && workers[current_worker]->deque.take(t);
+        found = found || injected.try_pop(t);
+        const size_t n = workers.size();
+        const size_t first = mine ? current_worker + 1 : 0;
+        for (size_t k = 0; !found && k < n; ++k)
+        {
+            found = workers[(first + k) % n]->deque.steal(t);
+        }
+        if (found)
+        {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return found;
+    }
+
+    void run(Task* t)
+    {
+        {
+            std::unique_ptr<Task> owned{ t };
+            owned->run();
+        }
+        task_done.notify();
+    }
+
+    void work(size_t i)
+    {
+        current_pool = this;
+        current_worker = i;
+        const std::stop_token stop = stopping.get_token();
+        for (;;)
+        {
+            Task* t;
+            if (find_work(t))
+            {
+                run(t);
+                continue;
+            }
+            const unsigned key = work_available.prepare_wait();
+            if (queued.load() != 0)
+            {
+                // submitted but not visible yet, or just taken by another
+                work_available.cancel_wait();
+                std::this_thread::yield();
+                continue;
+            }
+            if (stop.stop_requested())
+            {
+                work_available.cancel_wait();
+                return;
+            }
+            work_available.wait(key);
+        }
+    }
+
+#ifdef __linux__
+    // pins each worker to the i-th of the CPUs this process may run on
+    void pin()
+    {
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof allowed, &allowed) != 0)
+        {
+            throw std::system_error{ errno, std::generic_category(), "Thread_pool: sched_getaffinity" };
+        }
+        std::vector<int> cpus;
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+        {
+            if (CPU_ISSET(c, &allowed))
+            {
+                cpus.push_back(c);
+            }
+        }
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpus[i % cpus.size()], &one);
+            if (const int rc = pthread_setaffinity_np(threads[i].native_handle(), sizeof one, &one))
+            {
+                throw std::system_error{ rc, std::generic_category(), "Thread_pool: pthread_setaffinity_np" };
+            }
+        }
+    }
+#else
+    void pin() {}
+#endif
+public:
+    // n workers (0 means one per core), optionally pinned one per core
+    explicit Thread_pool(unsigned n = 0, bool pinned = false)
+    {
+        if (n == 0)
+        {
+            n = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < n; ++i)
+        {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        try
+        {
+            for (unsigned i = 0; i < n; ++i)
+            {
+                threads.emplace_back([this, i]{ work(i); });
+            }
+            if (pinned)
+            {
+                pin();
+            }
+        }
+        catch (...)
+        {
+            request_stop();
+            threads.clear();
+            throw;
+        }
+    }
+    Thread_pool(const Thread_pool&) = delete;
+    Thread_pool& operator=(const Thread_pool&) = delete;
+
+    ~Thread_pool()
+    {
+        request_stop();
+        threads.clear();
+        // whatever was submitted after the workers left: its futures get
+        // broken_promise
+        for (Task* t; injected.try_pop(t); )
+        {
+            delete t;
+        }
+        for (auto& w : workers)
+        {
+            for (Task* t; w->deque.steal(t); )
+            {
+                delete t;
+            }
+        }
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // the workers finish the tasks already submitted, then return;
+    // long tasks can poll get_stop_token() to finish sooner
+    void request_stop()
+    {
+        stopping.request_stop();
+        work_available.wake();
+    }
+    std::stop_token get_stop_token() const { return stopping.get_token(); }
+
+    template<typename F>
+    std::future<std::invoke_result_t<F&>> submit(F f)
+    {
+        using R = std::invoke_result_t<F&>;
+        std::packaged_task<R()> task{ std::move(f) };
+        auto result = task.get_future();
+        enqueue(new Task_of<std::packaged_task<R()>>{ std::move(task) });
+        return result;
+    }
+
+    // nested run_until()s in which a worker still takes any task
+    static constexpr size_t max_nesting = 64;
+
+    // waits until done() is true; done() must read what it tests with
+    // seq_cst loads (see Event). A worker runs tasks meanwhile, so that a
+    // task waiting for another keeps the worker busy and the pool cannot
+    // run out of threads while the other task is queued: any task it can
+    // find, up to max_nesting deep, and beyond that only the newest it
+    // pushed itself, whose nesting goes no deeper than their own
+    // recursion (so waits chained deeper than that can still stall, with
+    // the task waited for queued elsewhere). Any other thread sleeps until a task finishes, so the
+    // pool's tasks never run on its stack.
+    template<typename P>
+    void run_until(P done)
+    {
+        if (current_pool != this)
+        {
+            while (!done())
+            {
+                const unsigned key = task_done.prepare_wait();
+                if (done())
+                {
+                    task_done.cancel_wait();
+                    return;
+                }
+                task_done.wait(key);
+            }
+            return;
+        }
+        while (!done())
+        {
+            Task* t;
+            if (nesting < max_nesting ? find_work(t) : take_own(t))
+            {
+                ++nesting;
+                run(t);
+                --nesting;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // f.get(), but safe to call from a task: a worker runs tasks instead
+    // of blocking (see run_until()); any other thread blocks in f.get()
+    template<typename R>
+    R get(std::future<R>& f)
+    {
+        if (current_pool == this)
+        {
+            run_until([&]{ return f.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready; });
+        }
+        return f.get();
+    }
+
+    /**
+     * f(i) for i in [first, last), grain indices at a time (0: about 8
+     * chunks per worker), by the calling thread and up to size() workers.
+     * Chunks not started when stop is requested or f throws are skipped;
+     * the first exception is rethrown.
+     */
+    template<typename F>
+    void parallel_for(size_t first, size_t last, F f, size_t grain = 0, std::stop_token stop = {})
+    {
+        if (first >= last)
+        {
+            return;
+        }
+        const size_t n = last - first;
+        if (grain == 0)
+        {
+            grain = std::max<size_t>(1, n / (8 * size()));
+        }
+        const size_t chunks = (n + grain - 1) / grain;
+
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> finished{ 0 };
+        std::atomic_flag failed;
+        std::exception_ptr error;
+        auto body = [&]
+        {
+            for (size_t k; (k = next++) < chunks; )
+            {
+                if (failed.test(std::memory_order_relaxed) || stop.stop_requested())
+                {
+                    continue;
+                }
+                try
+                {
+                    const size_t b = first + k * grain;
+                    const size_t e = std::min(last, b + grain);
+                    for (size_t i = b; i < e; ++i)
+                    {
+                        f(i);
+                    }
+                }
+                catch (...)
+                {
+                    if (!failed.test_and_set())
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        // helpers that start after the chunks are gone return at once,
+        // but they refer to this frame, so we wait for every one
+        const size_t helpers = std::min(chunks - 1, size());
+        for (size_t h = 0; h < helpers; ++h)
+        {
+            auto helper = [&]{
+                body();
+                finished.fetch_add(1);
+            };
+            enqueue(new Task_of<decltype(helper)>{ std::move(helper) });
+        }
+        body();
+        run_until([&]{ return finished.load() == helpers; });
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+}
+
+#endif
@@ -31,15 +31,23 @@ void locked_increment(int& result)
     }
 }
 
+#include <concepts>
+
+// Lock: std::mutex (by default m) or anything else std::scoped_lock
+// takes, e.g. the locks in locks.hpp
+template<typename Lock = std::mutex>
 struct locked_increment_t
 {
     int& result;
-    locked_increment_t(int& r) : result{r} {}
+    Lock& lock;
+    int count;
+    locked_increment_t(int& r) requires std::same_as<Lock, std::mutex> : result{r}, lock{m}, count{counter} {}
+    locked_increment_t(int& r, Lock& l, int n = counter) : result{r}, lock{l}, count{n} {}
     void operator()()
     {
-        for (auto c = counter; c!=0; c--)
+        for (auto c = count; c!=0; c--)
         {
-            std::scoped_lock lck{m};
+            std::scoped_lock lck{lock};
             result++;
         }
     }
@@ -119,10 +127,174 @@ std::pair<int, int> duration_of(void (fp)())
     return {std::ranges::min(durations), std::ranges::max(durations)};
 }
 
+#include "counters.hpp"
+
+// ns per increment for counter increments shared out among nthreads
+// threads, each running body(thread_index, its_share)
+template<typename F>
+double ns_per_increment(unsigned nthreads, F body)
+{
+    using namespace std::chrono;
+    auto t1_start = high_resolution_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned i = 0; i != nthreads; ++i)
+            threads.emplace_back(body, i, counter / nthreads + (i < counter % nthreads));
+    }
+    auto t1_end = high_resolution_clock::now();
+    return duration<double, std::nano>(t1_end - t1_start).count() / counter;
+}
+
 #include <iostream>
+#include <iomanip>
+
+// the same counter increments, shared out among more and more threads,
+// into each kind of counter
+void counter_sweep()
+{
+    const unsigned max_threads = std::max(8u, 2 * std::thread::hardware_concurrency());
+    std::cout << "ns per increment, " << counter << " increments\n"
+        << "threads   mutex  atomic  shards packed  shards padded  local\n";
+    for (unsigned n = 1; n <= max_threads; n *= 2)
+    {
+        int result {0};
+        std::mutex mm;
+        double mutex_ns = ns_per_increment(n, [&](unsigned, int k) {
+            for (auto c = k; c!=0; c--)
+            {
+                std::scoped_lock lck{mm};
+                result++;
+            }
+        });
+        assert( result == counter );
+
+        my::Atomic_counter a;
+        double atomic_ns = ns_per_increment(n, [&](unsigned, int k) {
+            for (auto c = k; c!=0; c--)
+                a.add();
+        });
+        assert( a.get() == counter );
+
+        my::Sharded_counter<alignof(std::atomic<long>)> packed{n};
+        double packed_ns = ns_per_increment(n, [&](unsigned i, int k) {
+            for (auto c = k; c!=0; c--)
+                packed.add(i);
+        });
+        assert( packed.get() == counter );
+
+        my::Sharded_counter<> padded{n};
+        double padded_ns = ns_per_increment(n, [&](unsigned i, int k) {
+            for (auto c = k; c!=0; c--)
+                padded.add(i);
+        });
+        assert( padded.get() == counter );
+
+        my::Local_counter l;
+        double local_ns = ns_per_increment(n, [&](unsigned, int k) {
+            my::Local_counter::Local mine{l};
+            for (auto c = k; c!=0; c--)
+                mine.add();
+        });
+        assert( l.get() == counter );
+
+        std::cout << std::setw(7) << n << std::fixed << std::setprecision(2)
+            << std::setw(8) << mutex_ns << std::setw(8) << atomic_ns
+            << std::setw(15) << packed_ns << std::setw(15) << padded_ns
+            << std::setw(7) << local_ns << '\n';
+    }
+}
+
+#include "locks.hpp"
+
+#include <latch>
+#include <atomic>
+#include <numeric>
 
-int main()
+constexpr std::chrono::milliseconds lock_run {200};
+
+// nthreads threads, started together, each taking the lock and
+// incrementing for lock_run: throughput in M increments/s, and fairness
+// as the fewest increments a thread made over the most (1: all equal)
+template<typename Lock>
+std::pair<double, double> lock_throughput(unsigned nthreads)
+{
+    using namespace std::chrono;
+    int result {0};
+    Lock lock;
+    std::vector<long> taken(nthreads);
+    std::atomic<bool> stop {false};
+    std::latch start {nthreads + 1};
+    high_resolution_clock::time_point t1_start;
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned i = 0; i != nthreads; ++i)
+            threads.emplace_back([&, i] {
+                long n = 0;
+                start.arrive_and_wait();
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    std::scoped_lock lck{lock};
+                    result++;
+                    n++;
+                }
+                taken[i] = n;
+            });
+        start.arrive_and_wait();
+        t1_start = high_resolution_clock::now();
+        std::this_thread::sleep_for(lock_run);
+        stop.store(true, std::memory_order_relaxed);
+    }
+    auto t1_end = high_resolution_clock::now();
+    auto [fewest, most] = std::ranges::minmax(taken);
+    assert( result == std::accumulate(taken.begin(), taken.end(), 0L) );
+    return {result / duration<double>(t1_end - t1_start).count() / 1e6, most ? double(fewest) / most : 1.0};
+}
+
+template<typename Lock>
+void lock_row(const char* name, unsigned max_threads)
 {
+    std::cout << std::setw(12) << std::left << name << std::right;
+    for (unsigned n = 1; n <= max_threads; n *= 2)
+    {
+        auto [throughput, fairness] = lock_throughput<Lock>(n);
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << throughput
+            << " (" << std::setprecision(2) << fairness << ')' << std::flush;
+    }
+    std::cout << '\n';
+}
+
+// each lock type at 1, 2, 4, ... threads
+void lock_sweep()
+{
+    const unsigned max_threads = std::max(8u, 2 * std::thread::hardware_concurrency());
+    std::cout << "M locked increments/s (fewest increments by a thread / most), "
+        << lock_run.count() << " ms each\nthreads:    ";
+    for (unsigned n = 1; n <= max_threads; n *= 2)
+        std::cout << std::setw(15) << n;
+    std::cout << '\n';
+    lock_row<std::mutex>("std::mutex", max_threads);
+    lock_row<my::Futex_mutex>("futex", max_threads);
+    lock_row<my::Ttas_lock>("ttas", max_threads);
+    lock_row<my::Ticket_lock>("ticket", max_threads);
+    lock_row<my::Mcs_lock>("mcs", max_threads);
+}
+
+#include <string_view>
+
+// usage: threads [sweep|locks]
+// sweep: only the counter sweep; locks: only the lock sweep
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::string_view{argv[1]} == "sweep")
+    {
+        counter_sweep();
+        return 0;
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "locks")
+    {
+        lock_sweep();
+        return 0;
+    }
     /*
     using namespace std::chrono;
     auto t1_start = high_resolution_clock::now();
@@ -147,4 +319,7 @@ int main()
     auto [d5_min, d5_max] = duration_of(locked_serial_threads);
     std::cout << "locked_serial_threads:        "
         << d5_min << ',' << d5_max << '\n';
+
+    counter_sweep();
+    lock_sweep();
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#ifndef MY_WS_DEQUE_HPP
+#define MY_WS_DEQUE_HPP
+
+#include "event.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace my
+{
+
+// A work-stealing deque (Chase and Lev, with the C11 orderings of Le et
+// al.): its owner pushes and takes at the bottom like a stack, and any
+// other thread may steal from the top. The owner pays a fence only on
+// take(), and contends with thieves only for the last element.
+// T is a pointer or some other small trivially copyable type.
+template<typename T>
+class Ws_deque
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    struct Array
+    {
+        const std::int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Array(std::int64_t size) : mask{ size - 1 }, slots{ new std::atomic<T>[size] } {}
+        std::int64_t size() const { return mask + 1; }
+        T get(std::int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, T x) { slots[i & mask].store(x, std::memory_order_relaxed); }
+    };
+
+    alignas(cache_line) std::atomic<std::int64_t> top{ 0 };
+    alignas(cache_line) std::atomic<std::int64_t> bottom{ 0 };
+    std::atomic<Array*> array;
+    // a thief may still be reading an array that has been outgrown, so
+    // they are all kept until the deque goes
+    std::vector<std::unique_ptr<Array>> arrays;
+public:
+    // capacity is a power of 2; the deque doubles when it is full
+    explicit Ws_deque(std::int64_t capacity = 256)
+    {
+        arrays.push_back(std::make_unique<Array>(capacity));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+    Ws_deque(const Ws_deque&) = delete;
+    Ws_deque& operator=(const Ws_deque&) = delete;
+
+    // owner only
+    void push(T x)
+    {
+        const std::int64_t b = bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > a->mask)
+        {
+            auto bigger = std::make_unique<Array>(2 * a->size());
+            for (std::int64_t i = t; i < b; ++i)
+            {
+                bigger->put(i, a->get(i));
+            }
+            a = bigger.get();
+            arrays.push_back(std::move(bigger));
+            array.store(a, std::memory_order_release);
+        }
+        a->put(b, x);
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // owner only: the element pushed last; false if empty
+    bool take(T& x)
+    {
+        const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        x = a->get(b);
+        if (t == b)
+        {
+            // the last one: race the thieves for it
+            const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                         std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // any thread: the element pushed first; false if empty or another
+    // thread got it first
+    bool steal(T& x)
+    {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+        {
+            return false;
+        }
+        Array* a = array.load(std::memory_order_acquire);
+        x = a->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed);
+    }
+
+    // a guess, unless called by the owner while nobody steals
+    bool empty() const
+    {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,447 @@
+#ifndef MY_REDUCE_HPP
+#define MY_REDUCE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MY_REDUCE_X86 1
+#endif
+
+namespace my
+{
+
+enum class Summation
+{
+    fast,       // lanes running sums, added up at the end
+    pairwise,   // fast sums of blocks, added pairwise: error grows as log n
+    kahan,      // compensated in every lane: error does not grow with n
+};
+
+namespace reduce_impl
+{
+
+// Element i goes to running sum i % lanes and the lanes are added in a
+// fixed order, whether the loop runs on AVX2, SSE2 or neither, so a sum
+// comes out the same on every machine. (That also needs -ffp-contract=off,
+// the default for -std=c++NN, and no -ffast-math.)
+constexpr size_t lanes = 16;
+
+inline double add_lanes(const double* s)
+{
+    double t[lanes / 2];
+    for (size_t i = 0; i < lanes / 2; ++i)
+    {
+        t[i] = s[i] + s[i + lanes / 2];
+    }
+    return ((t[0] + t[4]) + (t[2] + t[6])) + ((t[1] + t[5]) + (t[3] + t[7]));
+}
+
+// adds x to s, carrying the low-order bits lost in c
+inline void kahan_add(double& s, double& c, double x)
+{
+    const double y = x - c;
+    const double t = s + y;
+    c = (t - s) - y;
+    s = t;
+}
+
+inline double add_lanes(const double* s, const double* c)
+{
+    double sum = 0, comp = 0;
+    for (size_t i = 0; i < lanes; ++i)
+    {
+        kahan_add(sum, comp, s[i]);
+    }
+    for (size_t i = 0; i < lanes; ++i)
+    {
+        kahan_add(sum, comp, -c[i]);
+    }
+    return sum;
+}
+
+// the loops below stop at a multiple i of lanes and leave the
+// n - i < lanes elements after it to these
+
+inline double sum_tail(const double* p, size_t i, size_t n, double* s)
+{
+    for (size_t j = 0; j < n - i; ++j)
+    {
+        s[j] += p[i + j];
+    }
+    return add_lanes(s);
+}
+
+inline double dot_tail(const double* p, const double* q, size_t i, size_t n, double* s)
+{
+    for (size_t j = 0; j < n - i; ++j)
+    {
+        s[j] += p[i + j] * q[i + j];
+    }
+    return add_lanes(s);
+}
+
+inline double kahan_tail(const double* p, size_t i, size_t n, double* s, double* c)
+{
+    for (size_t j = 0; j < n - i; ++j)
+    {
+        kahan_add(s[j], c[j], p[i + j]);
+    }
+    return add_lanes(s, c);
+}
+
+inline double sum_scalar(const double* p, size_t n)
+{
+    double s[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (size_t j = 0; j < lanes; ++j)
+        {
+            s[j] += p[i + j];
+        }
+    }
+    return sum_tail(p, i, n, s);
+}
+
+inline double dot_scalar(const double* p, const double* q, size_t n)
+{
+    double s[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (size_t j = 0; j < lanes; ++j)
+        {
+            s[j] += p[i + j] * q[i + j];
+        }
+    }
+    return dot_tail(p, q, i, n, s);
+}
+
+inline double kahan_scalar(const double* p, size_t n)
+{
+    double s[lanes] = {}, c[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (size_t j = 0; j < lanes; ++j)
+        {
+            kahan_add(s[j], c[j], p[i + j]);
+        }
+    }
+    return kahan_tail(p, i, n, s, c);
+}
+
+// min and max are exact, so the order does not matter; if p[i] is NaN, the
+// comparison is false and m stays, as it does with _mm256_min_pd(p[i], m)
+inline double min_scalar(const double* p, size_t n)
+{
+    double m = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; ++i)
+    {
+        m = p[i] < m ? p[i] : m;
+    }
+    return m;
+}
+
+inline double max_scalar(const double* p, size_t n)
+{
+    double m = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < n; ++i)
+    {
+        m = p[i] > m ? p[i] : m;
+    }
+    return m;
+}
+
+#ifdef MY_REDUCE_X86
+
+// SSE2 is part of x86-64: 8 registers of 2 lanes
+
+inline double sum_sse2(const double* p, size_t n)
+{
+    __m128d a[8];
+    for (auto& x : a) x = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (int k = 0; k < 8; ++k)
+        {
+            a[k] = _mm_add_pd(a[k], _mm_loadu_pd(p + i + 2 * k));
+        }
+    }
+    double s[lanes];
+    for (int k = 0; k < 8; ++k) _mm_storeu_pd(s + 2 * k, a[k]);
+    return sum_tail(p, i, n, s);
+}
+
+inline double dot_sse2(const double* p, const double* q, size_t n)
+{
+    __m128d a[8];
+    for (auto& x : a) x = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (int k = 0; k < 8; ++k)
+        {
+            a[k] = _mm_add_pd(a[k], _mm_mul_pd(_mm_loadu_pd(p + i + 2 * k), _mm_loadu_pd(q + i + 2 * k)));
+        }
+    }
+    double s[lanes];
+    for (int k = 0; k < 8; ++k) _mm_storeu_pd(s + 2 * k, a[k]);
+    return dot_tail(p, q, i, n, s);
+}
+
+// AVX2 machines: 4 registers of 4 lanes
+
+__attribute__((target("avx2")))
+inline double sum_avx2(const double* p, size_t n)
+{
+    __m256d a0 = _mm256_setzero_pd(), a1 = a0, a2 = a0, a3 = a0;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        a0 = _mm256_add_pd(a0, _mm256_loadu_pd(p + i));
+        a1 = _mm256_add_pd(a1, _mm256_loadu_pd(p + i + 4));
+        a2 = _mm256_add_pd(a2, _mm256_loadu_pd(p + i + 8));
+        a3 = _mm256_add_pd(a3, _mm256_loadu_pd(p + i + 12));
+    }
+    double s[lanes];
+    _mm256_storeu_pd(s, a0);
+    _mm256_storeu_pd(s + 4, a1);
+    _mm256_storeu_pd(s + 8, a2);
+    _mm256_storeu_pd(s + 12, a3);
+    return sum_tail(p, i, n, s);
+}
+
+__attribute__((target("avx2")))
+inline double dot_avx2(const double* p, const double* q, size_t n)
+{
+    __m256d a[4];
+    for (auto& x : a) x = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            // not an FMA, which would round differently from the others
+            a[k] = _mm256_add_pd(a[k], _mm256_mul_pd(_mm256_loadu_pd(p + i + 4 * k),
+                                                     _mm256_loadu_pd(q + i + 4 * k)));
+        }
+    }
+    double s[lanes];
+    for (int k = 0; k < 4; ++k) _mm256_storeu_pd(s + 4 * k, a[k]);
+    return dot_tail(p, q, i, n, s);
+}
+
+__attribute__((target("avx2")))
+inline double kahan_avx2(const double* p, size_t n)
+{
+    __m256d s[4], c[4];
+    for (int k = 0; k < 4; ++k) s[k] = c[k] = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            const __m256d y = _mm256_sub_pd(_mm256_loadu_pd(p + i + 4 * k), c[k]);
+            const __m256d t = _mm256_add_pd(s[k], y);
+            c[k] = _mm256_sub_pd(_mm256_sub_pd(t, s[k]), y);
+            s[k] = t;
+        }
+    }
+    double ss[lanes], cc[lanes];
+    for (int k = 0; k < 4; ++k)
+    {
+        _mm256_storeu_pd(ss + 4 * k, s[k]);
+        _mm256_storeu_pd(cc + 4 * k, c[k]);
+    }
+    return kahan_tail(p, i, n, ss, cc);
+}
+
+__attribute__((target("avx2")))
+inline double min_avx2(const double* p, size_t n)
+{
+    __m256d m[4];
+    for (auto& x : m) x = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            m[k] = _mm256_min_pd(_mm256_loadu_pd(p + i + 4 * k), m[k]);
+        }
+    }
+    double s[lanes];
+    for (int k = 0; k < 4; ++k) _mm256_storeu_pd(s + 4 * k, m[k]);
+    const double a = min_scalar(s, lanes), b = min_scalar(p + i, n - i);
+    return b < a ? b : a;
+}
+
+__attribute__((target("avx2")))
+inline double max_avx2(const double* p, size_t n)
+{
+    __m256d m[4];
+    for (auto& x : m) x = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            m[k] = _mm256_max_pd(_mm256_loadu_pd(p + i + 4 * k), m[k]);
+        }
+    }
+    double s[lanes];
+    for (int k = 0; k < 4; ++k) _mm256_storeu_pd(s + 4 * k, m[k]);
+    const double a = max_scalar(s, lanes), b = max_scalar(p + i, n - i);
+    return b > a ? b : a;
+}
+
+inline bool has_avx2()
+{
+    static const bool yes = __builtin_cpu_supports("avx2");
+    return yes;
+}
+
+#endif
+
+// blocks of this many are summed fast before being added pairwise
+constexpr size_t pairwise_block = 1024;
+
+template<typename F>
+double sum_pairwise(const double* p, size_t n, F sum_block)
+{
+    if (n <= pairwise_block)
+    {
+        return sum_block(p, n);
+    }
+    const size_t half = (n / pairwise_block + 1) / 2 * pairwise_block;
+    return sum_pairwise(p, half, sum_block) + sum_pairwise(p + half, n - half, sum_block);
+}
+
+}
+
+/**
+ * Reductions over contiguous doubles, with 16 independent running values
+ * so that the loop is limited by loads rather than by the latency of adds;
+ * AVX2 is used when the processor has it.
+ * sum() and dot() give the same result whichever instructions they run on,
+ * but in general not the one a plain left-to-right loop gives.
+ * min() and max() skip NaNs; of nothing, they are +inf and -inf.
+ */
+inline double sum(std::span<const double> v, Summation how = Summation::fast)
+{
+    using namespace reduce_impl;
+    const double* p = v.data();
+    const size_t n = v.size();
+#ifdef MY_REDUCE_X86
+    if (has_avx2())
+    {
+        switch (how)
+        {
+        case Summation::fast:     return sum_avx2(p, n);
+        case Summation::pairwise: return sum_pairwise(p, n, sum_avx2);
+        case Summation::kahan:    return kahan_avx2(p, n);
+        }
+    }
+    switch (how)
+    {
+    case Summation::fast:     return sum_sse2(p, n);
+    case Summation::pairwise: return sum_pairwise(p, n, sum_sse2);
+    case Summation::kahan:    return kahan_scalar(p, n);
+    }
+#endif
+    switch (how)
+    {
+    case Summation::fast:     return sum_scalar(p, n);
+    case Summation::pairwise: return sum_pairwise(p, n, sum_scalar);
+    case Summation::kahan:    return kahan_scalar(p, n);
+    }
+    return 0;
+}
+
+// the sum of v[i] * w[i] over the shorter of the two
+inline double dot(std::span<const double> v, std::span<const double> w)
+{
+    using namespace reduce_impl;
+    const size_t n = v.size() < w.size() ? v.size() : w.size();
+#ifdef MY_REDUCE_X86
+    return has_avx2() ? dot_avx2(v.data(), w.data(), n) : dot_sse2(v.data(), w.data(), n);
+#else
+    return dot_scalar(v.data(), w.data(), n);
+#endif
+}
+
+inline double min(std::span<const double> v)
+{
+    using namespace reduce_impl;
+#ifdef MY_REDUCE_X86
+    if (has_avx2())
+    {
+        return min_avx2(v.data(), v.size());
+    }
+#endif
+    return min_scalar(v.data(), v.size());
+}
+
+inline double max(std::span<const double> v)
+{
+    using namespace reduce_impl;
+#ifdef MY_REDUCE_X86
+    if (has_avx2())
+    {
+        return max_avx2(v.data(), v.size());
+    }
+#endif
+    return max_scalar(v.data(), v.size());
+}
+
+// elements per chunk of parallel_sum(): 512 KB, a multiple of the lanes
+// and of a cache line
+constexpr size_t parallel_chunk = 1 << 16;
+
+/**
+ * sum() on nthreads threads (0 means one per core). v is cut into chunks
+ * of parallel_chunk elements, whichever threads take them, and their sums
+ * are added in chunk order, so the result does not depend on nthreads.
+ */
+inline double parallel_sum(std::span<const double> v, unsigned nthreads = 0,
+                           Summation how = Summation::fast)
+{
+    const size_t n_chunks = (v.size() + parallel_chunk - 1) / parallel_chunk;
+    if (nthreads == 0)
+    {
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nthreads = static_cast<unsigned>(std::min<size_t>(nthreads, n_chunks));
+
+    std::vector<double> partial(n_chunks);
+    std::atomic<size_t> next{ 0 };
+    auto work = [&]
+    {
+        for (size_t k; (k = next++) < n_chunks; )
+        {
+            partial[k] = sum(v.subspan(k * parallel_chunk,
+                                       std::min(parallel_chunk, v.size() - k * parallel_chunk)), how);
+        }
+    };
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned t = 1; t < nthreads; ++t)
+        {
+            threads.emplace_back(work);
+        }
+        work();
+    }
+    return sum(partial, how);
+}
+
+}
+
+#endif